@@ -0,0 +1,134 @@
+#ifndef PID_H
+#define PID_H
+
+#include "utils/angle.h"
+#include <algorithm>
+#include <cmath>
+
+// Features a Pid is built with. Each is an `if constexpr` branch, so a
+// disabled feature costs nothing per update.
+struct PidOptions {
+    bool filter_derivative = true; // low-pass the derivative term
+    bool anti_windup = true;       // clamp the integral and stop integrating while saturated
+    bool clamp_output = true;
+    bool slew_limit = false;       // limit how fast the output may change
+    bool settle_detection = true;
+    bool wrap_angle = false;       // error and measurement are angles in radians
+};
+
+template <typename T>
+struct PidGains {
+    T kp;
+    T ki;
+    T kd;
+};
+
+// Limits in output units per second where they are rates. Fields belonging to
+// a disabled option are ignored.
+template <typename T>
+struct PidConfig {
+    T output_limit = T(127);
+    T integral_limit = T(127);    // on ki * integral, output units
+    T integral_zone = T(0);       // integrate only while |error| is below this; 0 always integrates
+    T derivative_time_constant = T(0.02); // seconds
+    T slew_rate = T(1000);
+    T settle_error = T(1);
+    T settle_rate = T(1);         // measurement units per second
+    T settle_time = T(0.2);       // seconds
+};
+
+// PID with derivative on measurement, so setpoint steps do not kick the
+// output. No heap, no virtual calls; the state is a handful of scalars.
+template <typename T, PidOptions Options = PidOptions{}>
+class Pid {
+    public:
+        Pid(PidGains<T> gains, PidConfig<T> config = {}) : gains(gains), config(config) {}
+
+        // Output for one step of `dt` seconds.
+        T update(T setpoint, T measurement, T dt) {
+            const T error = difference(setpoint, measurement);
+            T rate = T(0);
+            if (primed && dt > T(0)) rate = difference(measurement, last_measurement) / dt;
+            last_measurement = measurement;
+            primed = true;
+
+            if constexpr (Options.filter_derivative) {
+                const T alpha = dt / (config.derivative_time_constant + dt);
+                filtered_rate += alpha * (rate - filtered_rate);
+                rate = filtered_rate;
+            }
+
+            T output = gains.kp * error - gains.kd * rate + gains.ki * integral;
+            const bool in_zone = config.integral_zone <= T(0) || std::abs(error) < config.integral_zone;
+            if constexpr (Options.anti_windup) {
+                // Only integrate while that does not push a saturated output further.
+                const bool saturated = std::abs(output) >= config.output_limit && (output > T(0)) == (error > T(0));
+                if (in_zone && !saturated) integral += error * dt;
+                if (gains.ki != T(0)) {
+                    const T limit = config.integral_limit / std::abs(gains.ki);
+                    integral = std::clamp(integral, -limit, limit);
+                }
+            } else if (in_zone) {
+                integral += error * dt;
+            }
+
+            if constexpr (Options.clamp_output) {
+                output = std::clamp(output, -config.output_limit, config.output_limit);
+            }
+            if constexpr (Options.slew_limit) {
+                const T step = config.slew_rate * dt;
+                output = std::clamp(output, last_output - step, last_output + step);
+            }
+            last_output = output;
+
+            if constexpr (Options.settle_detection) {
+                const bool still = std::abs(error) < config.settle_error && std::abs(rate) < config.settle_rate;
+                settled_time = still ? settled_time + dt : T(0);
+            }
+            last_error = error;
+            return output;
+        }
+
+        // True once the error and measurement rate have stayed inside their
+        // settle bands for settle_time.
+        bool settled() const {
+            static_assert(Options.settle_detection, "settled() needs PidOptions::settle_detection");
+            return settled_time >= config.settle_time;
+        }
+
+        T get_error() const { return last_error; }
+
+        T get_output() const { return last_output; }
+
+        void set_gains(PidGains<T> gains) { this->gains = gains; }
+
+        // Keeps the last output so a slew-limited controller resumes from it.
+        void reset() {
+            primed = false;
+            integral = T(0);
+            filtered_rate = T(0);
+            settled_time = T(0);
+            last_error = T(0);
+        }
+
+    private:
+        static T difference(T a, T b) {
+            if constexpr (Options.wrap_angle) {
+                return static_cast<T>(wrap_angle(static_cast<double>(a - b)));
+            } else {
+                return a - b;
+            }
+        }
+
+        PidGains<T> gains;
+        PidConfig<T> config;
+        bool primed = false;
+        T last_measurement = T(0);
+        T integral = T(0);
+        T filtered_rate = T(0);
+        T last_output = T(0);
+        T last_error = T(0);
+        T settled_time = T(0);
+};
+
+#endif // PID_H
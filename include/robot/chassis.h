@@ -2,9 +2,51 @@
 #define CHASSIS_H
 
 #include "pros/motor_group.hpp"
+#include "pros/rtos.hpp"
+#include "robot/drive_model.h"
+#include "robot/motion.h"
+#include "robot/sysid.h"
+#include "robot/tracking/drive_encoders.h"
+#include "robot/tracking/odometry.h"
+#include "utils/input_shaping.h"
 #include "utils/pose.h"
+#include "utils/seqlock.h"
+#include "utils/spsc_queue.h"
+#include "utils/triple_buffer.h"
+#include <atomic>
+#include <cstdint>
 #include <optional>
 
+struct LoopStats {
+    uint32_t ticks;
+    uint32_t overruns;
+    uint32_t last_tick_us;
+    uint32_t max_tick_us;
+    uint32_t max_jitter_us;
+};
+
+using OdometryStats = LoopStats;
+
+enum class DriveMode : uint8_t {
+    Power,   // joystick units through MotorGroup::move()
+    Velocity, // inches/second through the drive model
+    Voltage   // volts, uncompensated
+};
+
+struct MotionProgress {
+    uint32_t id;       // motions started so far, counting this one
+    float travelled;   // inches, or radians for a turn
+    float elapsed_ms;
+};
+
+struct DriveCommand {
+    DriveMode mode;
+    float left;
+    float right;
+    float left_acceleration;
+    float right_acceleration;
+};
+
 class Chassis {
 public:
     // Constructors
@@ -14,14 +56,115 @@ public:
         std::optional<float> right_joystick_y_deadzone);
 
     // User Control
+    // Inputs are in joystick units, shaped by the constructor deadzones and
+    // the drive profile. Once the control task is running these only publish
+    // the setpoint; before that they write the motors directly.
     void tank(float left_joystick_y_position, float right_joystick_y_position);
 
+    // Throttle plus turn per side. Turn is clockwise positive.
+    void arcade(float throttle, float turn);
+
+    // Turn sets path curvature, so turning rate scales with throttle; at low
+    // throttle it fades smoothly into turning in place.
+    void curvature(float throttle, float turn);
+
+    // Switches curves between drivers. Call from the task that drives.
+    void set_drive_profile(const DriveProfile& profile);
+
+    // While odometry reports slip, drive output is capped at `max_output`
+    // (joystick units) to regain traction. nullopt removes the cap.
+    void set_slip_limit(std::optional<float> max_output);
+
+    // Drive Control
+    // Starts the task that owns every drive motor write, at a fixed period
+    // (5-20 ms) independent of the caller's loop.
+    void start_control(uint32_t period_ms = 10);
+
+    LoopStats get_control_stats() const;
+
+    // Feedforward and feedback constants for drive_velocity(). Call before
+    // start_control(). Feedback needs set_drive_encoders() for the wheel
+    // geometry; without it the output is feedforward only.
+    void set_drive_model(const DriveModel& model);
+
+    // Side velocities (inches/second) and accelerations (inches/second^2),
+    // held by the control task until the next command.
+    void drive_velocity(float left, float right, float left_acceleration = 0.0f, float right_acceleration = 0.0f);
+
+    // Blocks while the drive runs the characterization tests in sysid.h,
+    // then writes the samples to `path` as CSV for tools/sysid_fit.cpp.
+    // Needs set_drive_encoders(). Returns false if that is missing or the
+    // file could not be written.
+    bool run_sysid(const char* path, SysidConfig config = {});
+
+    // Autonomous Motion
+    // Motions queue up in the control task and run one after another on the
+    // odometry pose, so start_control() and start_odometry() come first.
+    // Headings are radians, clockwise positive. With `async` a call returns
+    // once the motion is queued (waiting for room if the queue is full);
+    // otherwise it blocks until the motion settles (true), times out or is
+    // cancelled (false). A drive command cancels every motion.
+    bool turn_to_heading(float heading, TurnParams params = {}, bool async = false);
+
+    bool turn_to_point(float x, float y, TurnParams params = {}, bool async = false);
+
+    bool move_to_point(float x, float y, MoveParams params = {}, bool async = false);
+
+    // Boomerang: curves in to arrive at (x, y) facing `heading`.
+    bool move_to_pose(float x, float y, float heading, MoveParams params = {}, bool async = false);
+
+    // Pure pursuit along `path`, which must outlive the motion and have at
+    // least two points and be finished(). Ends within params.exit.error of
+    // the last point; params.lead is unused.
+    bool follow_path(const Path& path, MoveParams params = {}, bool async = false);
+
+    // These wait on the motion queued last, returning early if it ends
+    // before the condition is met: until it has driven `distance` inches
+    // (radians for a turn), run for `time_ms`, or `condition(get_pose())`.
+    void wait_until(float distance);
+
+    void wait_until_elapsed(uint32_t time_ms);
+
+    template <typename Condition>
+    void wait_until_pose(Condition condition) {
+        const uint32_t id = motions.last_id();
+        while (!motions.ended(id) && !condition(get_pose())) {
+            pros::delay(control_period_ms);
+        }
+    }
+
+    void wait_until_done();
+
+    // Stops the running motion and drops the queued ones, returning once the
+    // control task has done so (within one tick). Motions queued after it
+    // returns run as normal.
+    void cancel_motions();
+
+    bool is_in_motion() const;
+
+    // Call before start_control().
+    void set_motion_gains(const MotionGains& gains);
+
     // Odometry
+    void start_odometry(Odometry* odometry, uint32_t period_ms = 10);
+
+    // Gives odometry the drive motor encoders as a fallback source. Call
+    // before start_odometry().
+    void set_drive_encoders(DriveEncoderConfig config);
+
+    // Once odometry runs the reset is applied on its next tick. Call from
+    // one task at a time.
     void set_pose(float x, float y, float heading);
 
     void set_pose(Pose pose);
 
-    
+    Pose get_pose() const;
+
+    OdometryStats get_odometry_stats() const;
+
+    // While enabled, the odometry task learns IMU drift whenever the robot is
+    // disabled and provably stationary.
+    void set_imu_drift_learning(bool enabled);
 
 private:
     // Devices
@@ -31,9 +174,74 @@ private:
     // User Control
     float l_deadzone;
     float r_deadzone;
+    DriveProfile profile;
+
+    // (turn, throttle) after the radial deadzone and curves.
+    void shape_arcade(float& throttle, float& turn) const;
+
+    // Drive Control
+    void control_loop();
+
+    // Hands `command` to the control task, or applies it directly before
+    // the task starts.
+    void send_drive(const DriveCommand& command);
+
+    void write_drive(const DriveCommand& command);
+
+    void write_power(float left, float right);
+
+    void write_velocity(const DriveCommand& command);
+
+    double side_velocity(const pros::MotorGroup& motors) const;
+
+    uint32_t control_period_ms = 10;
+    std::optional<pros::Task> control_task;
+    // One producer (the driving task) to the control task, which only ever
+    // wants the newest command; a seqlock would let the higher priority
+    // control task spin on a preempted writer.
+    TripleBuffer<DriveCommand> drive_command;
+    DriveModel drive_model{{0, 0, 0}, {0, 0, 0}, 0};
+    double battery_volts = NOMINAL_BATTERY_VOLTS;
+    std::atomic<float> slip_limit{-1.0f}; // negative: no cap
+    SeqLock<LoopStats> control_stats{{}};
+
+    // Autonomous Motion
+    bool queue_motion(const Motion& motion, bool async);
+
+    void step_motion(DriveCommand& command);
+
+    // Waits until the motion queued last has `progress` or has ended.
+    template <typename Reached>
+    void wait_for_progress(Reached reached) const {
+        const uint32_t id = motions.last_id();
+        while (!motions.ended(id)) {
+            const MotionProgress progress = motion_progress.load();
+            if (progress.id == id && reached(progress)) return;
+            pros::delay(control_period_ms);
+        }
+    }
+
+    MotionController motion_controller;
+    MotionQueue motions;
+    SeqLock<MotionProgress> motion_progress{{0, 0.0f, 0.0f}};
 
     // Odometry
-    Pose pose = {0.0f, 0.0f, 0.0f};
+    void odometry_loop();
+
+    bool motors_still() const;
+
+    Odometry* odometry = nullptr;
+    uint32_t odometry_period_ms = 10;
+    std::optional<pros::Task> odometry_task;
+    std::optional<DriveEncoders> drive_encoders;
+
+    SeqLock<Pose> pose{{0.0f, 0.0f, 0.0f}};
+    // From the task calling set_pose() to the odometry task, which applies
+    // the newest; like drive_command, a seqlock here could leave the higher
+    // priority reader spinning on a preempted writer.
+    SpscQueue<Pose, 4> pose_resets;
+    std::atomic<bool> imu_drift_learning{false};
+    SeqLock<OdometryStats> odometry_stats{{}};
 };
 
-#endif // CHASSIS_H
\ No newline at end of file
+#endif // CHASSIS_H
@@ -0,0 +1,43 @@
+#ifndef DRIVE_MODEL_H
+#define DRIVE_MODEL_H
+
+#include <array>
+#include <cstdint>
+
+// Voltage to hold a velocity (V = kS sgn(v) + kV v + kA a), in volts and
+// inches per second.
+struct Feedforward {
+    double ks;
+    double kv;
+    double ka;
+};
+
+// Drive characterization. Side velocities split into a linear part (the
+// sides' mean) and an angular part (half their difference), each with its
+// own constants, since turning scrubs the wheels and loads the motors
+// differently from driving straight.
+struct DriveModel {
+    Feedforward linear;
+    Feedforward angular;
+    double kp;                        // volts per inch/second of velocity error
+    bool battery_compensation = true; // scale commands as battery voltage sags
+};
+
+inline constexpr double NOMINAL_BATTERY_VOLTS = 12.0;
+inline constexpr double MAX_MOTOR_VOLTS = 12.0;
+
+// Feedforward voltage (left, right) for side velocities and accelerations.
+std::array<double, 2> drive_feedforward(const DriveModel& model, double left_velocity, double right_velocity,
+    double left_acceleration, double right_acceleration);
+
+// Command for the motors' voltage mode, in millivolts. Motor voltage is a
+// share of the battery's, so with compensation the request is scaled by
+// nominal / measured battery voltage before clamping to the motor range.
+int32_t to_motor_millivolts(const DriveModel& model, double volts, double battery_volts);
+
+// "linear <ks> <kv> <ka>" and "angular <ks> <kv> <ka>" lines, as written by
+// tools/sysid_fit.cpp. Loading keeps the model's kp and compensation flag.
+bool save_drive_model(const char* path, const DriveModel& model);
+bool load_drive_model(const char* path, DriveModel& model);
+
+#endif // DRIVE_MODEL_H
@@ -0,0 +1,166 @@
+#ifndef MOTION_H
+#define MOTION_H
+
+#include "autonomous/controllers/pid.h"
+#include "path.h"
+#include "pure_pursuit.h"
+#include "utils/pose.h"
+#include "utils/spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+
+// Point-to-point motions on the odometry pose: x/y in inches, heading in
+// radians, clockwise positive from +x (so +y is to the robot's right at
+// heading 0). Outputs are joystick units per side.
+
+// A motion has settled once its error and the error's rate have stayed within
+// these bands for `time_ms`.
+struct ExitCondition {
+    float error;
+    float rate;       // per second
+    uint32_t time_ms;
+};
+
+// With a min_speed a motion is chained: its output never drops below
+// min_speed, and it ends as soon as the error is inside the exit band (or the
+// target has been passed) instead of settling, so the next queued motion
+// takes over without the robot stopping.
+struct TurnParams {
+    uint32_t timeout_ms = 3000;
+    float max_speed = 127.0f;
+    float min_speed = 0.0f;
+    ExitCondition exit = {0.02f, 0.1f, 100}; // about 1 degree, 6 degrees/second
+};
+
+struct MoveParams {
+    uint32_t timeout_ms = 5000;
+    float max_speed = 127.0f;
+    float min_speed = 0.0f;
+    bool forwards = true;
+    float lead = 0.6f;                    // move_to_pose: how far the carrot leads, 0 to 1
+    ExitCondition exit = {1.0f, 2.0f, 100}; // inches, inches/second
+};
+
+struct MotionGains {
+    PidGains<float> linear = {10.0f, 0.0f, 1.0f};   // joystick units per inch
+    PidGains<float> angular = {120.0f, 0.0f, 8.0f}; // joystick units per radian
+    float close_distance = 6.0f; // inches; inside this, stop steering towards the point
+    PursuitConfig pursuit;
+};
+
+enum class MotionType : uint8_t {
+    TurnToHeading,
+    TurnToPoint,
+    MoveToPoint,
+    MoveToPose,
+    FollowPath
+};
+
+struct Motion {
+    MotionType type;
+    float x;
+    float y;
+    float heading;
+    TurnParams turn;
+    MoveParams move;
+    const Path* path = nullptr; // FollowPath
+};
+
+enum class MotionStatus : uint8_t {
+    Idle,
+    Running,
+    Settled,
+    TimedOut,
+    Cancelled
+};
+
+// Runs one Motion at a time, one step per control tick. A step is a couple
+// of trig calls and two PID updates regardless of the motion, so its cost is
+// bounded.
+class MotionController {
+    public:
+        static constexpr PidOptions linear_options = {true, true, true, false, true, false};
+        static constexpr PidOptions angular_options = {true, true, true, false, true, true};
+
+        explicit MotionController(MotionGains gains = {});
+
+        void set_gains(const MotionGains& gains);
+
+        void start(const Motion& motion);
+
+        // Left and right output for a tick `dt` seconds long. Returns Running
+        // until the motion settles or times out; Idle if none is active.
+        MotionStatus step(Pose pose, float dt, float& left, float& right);
+
+        void cancel();
+
+        bool active() const;
+
+        // Since start(): inches driven (radians turned, for a turn) and seconds.
+        float get_travelled() const;
+
+        float get_elapsed() const;
+
+    private:
+        // Pure pursuit along motion.path at `speed` inches/second.
+        MotionStatus follow_path(Pose pose, float speed, float& left, float& right);
+
+        MotionGains gains;
+        Motion motion{};
+        bool running = false;
+        float elapsed = 0.0f;
+        float travelled = 0.0f;
+        bool primed = false;
+        float last_x = 0.0f;
+        float last_y = 0.0f;
+        float last_heading = 0.0f;
+        bool close = false;
+        Pid<float, linear_options> linear;
+        Pid<float, angular_options> angular;
+        PurePursuit pursuit;
+};
+
+// Motions handed from the task that queues them to the control task, which
+// runs them one at a time on a MotionController. Ids count up from 1 in
+// queue order, and an id has ended once that motion and all before it have.
+// push(), cancel() and last_id() are for the queuing task; start_next(),
+// finish() and clear() for the control task.
+class MotionQueue {
+    public:
+        // Returns the motion's id, or 0 if the queue is full.
+        uint32_t push(const Motion& motion);
+
+        // Cancels every motion pushed so far, running or queued. Motions
+        // pushed after it returns are unaffected.
+        void cancel();
+
+        uint32_t last_id() const;
+
+        bool ended(uint32_t id) const;
+
+        // How the most recently ended motion ended.
+        MotionStatus last_status() const;
+
+        // Starts the next queued motion on `controller` if it is idle.
+        // Returns whether a motion is running; its id is running_id().
+        bool start_next(MotionController& controller);
+
+        uint32_t running_id() const;
+
+        void finish(MotionStatus status);
+
+        // Ends the running motion and the queued ones as Cancelled: all of
+        // them if `all`, otherwise those a cancel() covers. Returns whether
+        // any ended.
+        bool clear(MotionController& controller, bool all);
+
+    private:
+        SpscQueue<Motion, 8> requests;
+        uint32_t requested = 0; // queuing task side
+        uint32_t started = 0;   // control task side
+        std::atomic<uint32_t> finished{0};
+        std::atomic<uint32_t> cancelled{0};
+        std::atomic<MotionStatus> final_status{MotionStatus::Idle};
+};
+
+#endif // MOTION_H
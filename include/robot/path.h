@@ -0,0 +1,42 @@
+#ifndef PATH_H
+#define PATH_H
+
+#include <cstddef>
+#include <vector>
+
+// Dense path for PurePursuit, stored as parallel arrays so a search over
+// neighbouring points walks contiguous memory. Build it (or load it) before
+// autonomous starts; following it never allocates.
+class Path {
+    public:
+        void reserve(std::size_t points);
+
+        // Appends a point, in inches. Points closer than 1e-3 inches to the
+        // last one are dropped.
+        void add_point(float x, float y);
+
+        // Fills curvature from the points; call after the last add_point().
+        void finish();
+
+        // Whether curvature covers every point, i.e. finish() has run since
+        // the last add_point().
+        bool finished() const;
+
+        void clear();
+
+        std::size_t size() const;
+
+        // Per point: position, arc length from the start, and signed curvature
+        // (1/inches, positive turning clockwise).
+        std::vector<float> x;
+        std::vector<float> y;
+        std::vector<float> distance;
+        std::vector<float> curvature;
+};
+
+// Reads one "x, y" (or "x y") point per line; other lines are skipped, so
+// exported path files with headers and trailing fields load as is. Returns
+// false if the file is missing or has fewer than two points.
+bool load_path(const char* file, Path& path);
+
+#endif // PATH_H
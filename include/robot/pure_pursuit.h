@@ -0,0 +1,46 @@
+#ifndef PURE_PURSUIT_H
+#define PURE_PURSUIT_H
+
+#include "path.h"
+#include "utils/pose.h"
+#include <cstddef>
+
+struct PursuitConfig {
+    float min_lookahead = 6.0f;   // inches
+    float max_lookahead = 18.0f;
+    float speed_lookahead = 0.25f; // extra lookahead per inch/second of speed
+    float curvature_lookahead = 20.0f; // lookahead is divided by 1 + this * |path curvature|
+    float curvature_slowdown = 20.0f;  // and so is speed
+    float track_width = 12.0f;    // inches, for splitting the arc into sides
+    std::size_t max_search_points = 256; // per search, whatever the spacing
+};
+
+struct PursuitTarget {
+    float curvature;      // of the arc to the lookahead point, 1/inches, clockwise positive
+    float path_curvature; // at the closest point
+    float remaining;      // inches to the end of the path
+    float end_along;      // distance to the last point along the robot's heading
+    bool at_end;          // the lookahead point is the last point
+};
+
+// Pure pursuit over a Path. The closest point and the lookahead point only
+// move forwards, and each search starts from where the last one stopped and
+// covers at most max_search_points within the lookahead's reach, so the cost
+// per step does not depend on the path's length.
+class PurePursuit {
+    public:
+        void reset();
+
+        // `heading` is the direction of travel (the pose heading plus pi when
+        // following backwards); `speed` the measured speed in inches/second.
+        // A path that is empty or not finished() ends the follow at once.
+        PursuitTarget step(const Path& path, Pose pose, float heading, float speed, const PursuitConfig& config);
+
+        std::size_t get_closest() const;
+
+    private:
+        std::size_t closest = 0;
+        std::size_t lookahead = 0;
+};
+
+#endif // PURE_PURSUIT_H
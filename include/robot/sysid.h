@@ -0,0 +1,55 @@
+#ifndef SYSID_H
+#define SYSID_H
+
+#include <cstddef>
+#include <cstdint>
+
+// Drive characterization run by Chassis::run_sysid(). Each test runs once
+// forwards and once backwards (clockwise, then counterclockwise, for the
+// angular ones):
+//   - quasistatic: voltage ramps slowly, so acceleration is negligible and
+//     the samples pin down kS and kV;
+//   - dynamic: a voltage step, whose acceleration pins down kA.
+// Linear tests need about two metres clear in front of and behind the robot.
+// With the defaults the whole run takes under a minute.
+enum class SysidTest : uint8_t {
+    QuasistaticLinear,
+    QuasistaticAngular,
+    DynamicLinear,
+    DynamicAngular
+};
+
+struct SysidConfig {
+    double ramp_rate = 1.0;        // volts per second
+    uint32_t quasistatic_ms = 5000;
+    double step_volts = 6.0;
+    uint32_t dynamic_ms = 1500;
+    uint32_t rest_ms = 1500;       // stopped between tests
+};
+
+// One motor update. Voltages are the commands that produced the velocities;
+// velocities in inches per second from the median motor on each side.
+struct SysidSample {
+    SysidTest test;
+    int8_t direction;
+    uint32_t time_ms;
+    float left_volts;
+    float right_volts;
+    float left_velocity;
+    float right_velocity;
+    float left_acceleration;
+    float right_acceleration;
+    float battery_volts;
+};
+
+// Test column of the CSV written by run_sysid().
+inline const char* sysid_test_name(SysidTest test) {
+    switch (test) {
+        case SysidTest::QuasistaticLinear: return "quasistatic_linear";
+        case SysidTest::QuasistaticAngular: return "quasistatic_angular";
+        case SysidTest::DynamicLinear: return "dynamic_linear";
+        default: return "dynamic_angular";
+    }
+}
+
+#endif // SYSID_H
@@ -0,0 +1,57 @@
+#ifndef DEVICE_SAMPLING_H
+#define DEVICE_SAMPLING_H
+
+#include "drive_encoders.h"
+#include "odometry.h"
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+// Per-device read helpers behind Odometry::sample(). They are templates over
+// the device so the host tools can time them against stand-ins.
+
+// Reads motors one index at a time into a stack buffer; get_position_all()
+// would allocate a vector every tick for the same kernel calls.
+template <typename Motors>
+inline double median_position(Motors* motors) {
+    std::array<double, DriveEncoders::max_motors> positions;
+    const std::size_t count = std::min<std::size_t>(motors->size(), positions.size());
+    for (std::size_t i = 0; i < count; i++) positions[i] = motors->get_position(i);
+    return DriveEncoders::median(positions, count);
+}
+
+enum class SampleResult {
+    NotDue,
+    Repeat, // read, but equal to the previous value
+    Fresh
+};
+
+// Reads a device once it is due. A repeat of the previous value means the
+// device has not updated yet (or is not moving), so it is retried next tick;
+// a new value pushes the next read out by the device's period (less a
+// millisecond of slack for tick jitter).
+template <typename Value, typename Read>
+inline SampleResult sample_device(uint64_t now, uint32_t period_ms, uint64_t& due, SampleStats& stats,
+    Value& value, uint64_t& sample_us, Read read) {
+    if (now < due) return SampleResult::NotDue;
+    const Value reading = read();
+    stats.reads++;
+    if (stats.reads > 1 && reading == value) {
+        stats.duplicates++;
+        return SampleResult::Repeat;
+    }
+    value = reading;
+    sample_us = now;
+    stats.last_fresh_us = now;
+    due = now + std::max<uint64_t>(period_ms, 1) * 1000 - 1000;
+    return SampleResult::Fresh;
+}
+
+// Sets bit `index` of `stale` unless the read was fresh, and of `repeat` if
+// the device was read but repeated itself.
+inline void flag_sample(SampleResult result, std::size_t index, uint8_t& stale, uint8_t& repeat) {
+    if (result != SampleResult::Fresh) stale |= 1u << index;
+    if (result == SampleResult::Repeat) repeat |= 1u << index;
+}
+
+#endif // DEVICE_SAMPLING_H
@@ -0,0 +1,58 @@
+#ifndef DRIVE_ENCODERS_H
+#define DRIVE_ENCODERS_H
+
+#include "pros/motor_group.hpp"
+#include <array>
+#include <cstddef>
+
+struct DriveEncoderConfig {
+    double wheel_diameter;
+    double gear_ratio;  // wheel revolutions per motor revolution
+    double track_width;
+};
+
+// Dead reckoning from the drive motors' integrated encoders, for robots
+// without (or with failed) tracking wheels. Positions are the median motor
+// reading per side in degrees, so one bad motor on a side is rejected.
+class DriveEncoders {
+    public:
+        static constexpr std::size_t max_motors = 8;
+
+        DriveEncoders(pros::MotorGroup* left_motors, pros::MotorGroup* right_motors, DriveEncoderConfig config);
+        // Accumulates one reading per side. The first reading only sets the
+        // reference.
+        void set_positions(double left, double right);
+        void resync(double left, double right);
+        // Larger side travel `left`/`right` would add since the last reading.
+        double peek_travel(double left, double right) const;
+        double degrees_to_distance(double degrees) const;
+        // Centre travel since the previous call.
+        double get_distance_delta();
+        // Travel of each side (left, right) in the last set_positions().
+        std::array<double, 2> get_side_deltas() const;
+        // Accumulated heading (clockwise positive, like the IMU) from the
+        // difference in side travel.
+        double get_heading_total() const;
+        DriveEncoderConfig get_config() const;
+        pros::MotorGroup* get_left_motors();
+        pros::MotorGroup* get_right_motors();
+
+        // Median of the first `count` positions, skipping non-finite readings
+        // (PROS_ERR_F). Reorders `positions`; NaN if none are usable.
+        static double median(std::array<double, max_motors>& positions, std::size_t count);
+
+    private:
+        pros::MotorGroup* left_motors;
+        pros::MotorGroup* right_motors;
+        DriveEncoderConfig config;
+        bool primed = false;
+        double last_left = 0;
+        double last_right = 0;
+        double total_left = 0;
+        double total_right = 0;
+        double last_centre = 0;
+        double step_left = 0;
+        double step_right = 0;
+};
+
+#endif // DRIVE_ENCODERS_H
@@ -0,0 +1,44 @@
+#ifndef FIELD_MAP_H
+#define FIELD_MAP_H
+
+#include <array>
+#include <cstddef>
+
+struct Segment {
+    float x1;
+    float y1;
+    float x2;
+    float y2;
+};
+
+// Static field geometry in inches with the origin at the field centre. Walls
+// and goals are line segments; build() precomputes a distance field so a ray
+// cast is a handful of table lookups instead of a segment intersection per
+// wall. The field is ~85 KB, so keep the map in static storage.
+class FieldMap {
+    public:
+        static constexpr float half_size = 72.0f;
+        static constexpr float resolution = 1.0f;
+        static constexpr std::size_t cells = static_cast<std::size_t>(2 * half_size / resolution) + 1;
+        static constexpr std::size_t max_segments = 32;
+
+        // Starts with the four perimeter walls.
+        FieldMap();
+
+        bool add_segment(const Segment& segment);
+
+        void build();
+
+        float distance(float x, float y) const;
+
+        // Sphere-traces from (x, y) along the unit direction (dx, dy). Returns
+        // max_range if nothing is hit.
+        float raycast(float x, float y, float dx, float dy, float max_range) const;
+
+    private:
+        std::array<Segment, max_segments> segments{};
+        std::size_t segment_count = 0;
+        std::array<float, cells * cells> field{};
+};
+
+#endif // FIELD_MAP_H
@@ -0,0 +1,43 @@
+#ifndef IMU_DRIFT_H
+#define IMU_DRIFT_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+struct ImuDrift {
+    double rate;       // heading drift in deg/s, removed during fusion
+    double learned_s;  // stationary time the estimate is built from
+};
+
+// Learns per-IMU heading drift from windows of samples taken while the robot
+// is known to be still. Each completed window's rotation slope is folded into
+// a running average; learned_s saturates so the estimate keeps tracking
+// temperature-driven changes.
+class ImuDriftEstimator {
+    public:
+        static constexpr std::size_t max_imus = 4;
+        static constexpr double window_s = 2.0;
+        static constexpr double memory_s = 30.0;
+
+        void sample(std::size_t index, double rotation, uint64_t timestamp_us);
+
+        // Motion was detected; partial windows are discarded.
+        void interrupt();
+
+        const ImuDrift& get(std::size_t index) const;
+
+        void set(std::size_t index, const ImuDrift& drift);
+
+    private:
+        struct Window {
+            bool open;
+            uint64_t start_us;
+            double start_rotation;
+        };
+
+        std::array<Window, max_imus> windows{};
+        std::array<ImuDrift, max_imus> drifts{};
+};
+
+#endif // IMU_DRIFT_H
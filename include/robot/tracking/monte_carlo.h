@@ -0,0 +1,104 @@
+#ifndef MONTE_CARLO_H
+#define MONTE_CARLO_H
+
+#include "field_map.h"
+#include "odometry.h"
+#include "pros/distance.hpp"
+#include "pros/rtos.hpp"
+#include "utils/pose.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <vector>
+
+// Mounting of a distance sensor in the odometry local frame (x forward).
+struct DistanceSensorConfig {
+    pros::Distance* sensor;
+    float x;
+    float y;
+    float angle;
+};
+
+struct MonteCarloConfig {
+    std::size_t particle_count = 300;
+    float translation_noise = 0.05f; // per unit of travel
+    float rotation_noise = 0.02f;    // per radian turned
+    float sensor_sigma = 0.8f;       // inches, at full confidence
+    float max_range = 78.0f;         // inches
+    float units_per_mm = 1.0f / 25.4f;
+    float converged_spread = 3.0f;   // inches; spread above this is not reported
+    // Consecutive estimates share most of their evidence, so only one per
+    // period goes to Odometry, which fuses each as independent.
+    uint32_t submit_period_ms = 250;
+};
+
+// One Distance sensor sample: get_distance() and get_confidence().
+struct RangeReading {
+    int32_t distance_mm;
+    int32_t confidence;
+};
+
+// Particle filter that corrects Odometry against field walls using distance
+// sensors. Particles are stored structure-of-arrays, and motion comes from
+// Odometry's dead-reckoned pose so its own corrections never feed back in.
+// Weights carry over between cycles until resampling resets them, so the
+// posterior accumulates across readings.
+class MonteCarloLocalizer {
+    public:
+        static constexpr std::size_t max_particles = 512;
+        static constexpr std::size_t max_sensors = 6;
+
+        MonteCarloLocalizer(Odometry* odometry, const FieldMap* map,
+            std::vector<DistanceSensorConfig> sensors, MonteCarloConfig config = {});
+
+        void initialize(const Pose& pose, float spread_xy, float spread_heading);
+
+        using Ranges = std::array<RangeReading, max_sensors>;
+
+        // Samples the distance sensors and runs one cycle.
+        void update();
+
+        // The device-free predict/weigh/resample cycle on readings taken at
+        // `timestamp_us`, one per configured sensor; also used on the host.
+        // Submits the estimate to Odometry once the particles have converged,
+        // at most once per submit_period_ms.
+        void update(uint64_t timestamp_us, const Ranges& ranges);
+
+        void start(uint32_t period_ms = 10);
+
+        Pose get_estimate() const;
+
+    private:
+        struct Particles {
+            std::array<float, max_particles> x;
+            std::array<float, max_particles> y;
+            std::array<float, max_particles> heading;
+        };
+
+        void predict(const Pose& dead_reckoned);
+        bool weigh(const Ranges& ranges);
+        void resample();
+        void estimate(uint64_t timestamp_us);
+
+        float uniform();
+        float gaussian();
+
+        Odometry* odometry;
+        const FieldMap* map;
+        std::array<DistanceSensorConfig, max_sensors> sensors{};
+        std::size_t sensor_count;
+        MonteCarloConfig config;
+
+        Particles particles{};
+        Particles scratch{};
+        std::array<float, max_particles> weights{};
+
+        std::optional<Pose> last_dead_reckoned;
+        Pose estimate_pose = {0.0f, 0.0f, 0.0f};
+        std::optional<uint64_t> last_submit_us;
+        uint32_t rng_state = 0x9e3779b9;
+        std::optional<pros::Task> task;
+};
+
+#endif // MONTE_CARLO_H
@@ -1,14 +1,190 @@
 #ifndef ODOMETRY_H
 #define ODOMETRY_H
 
+#include "drive_encoders.h"
+#include "imu_drift.h"
+#include "pose_history.h"
+#include "pose_integrator.h"
+#include "pros/gps.hpp"
 #include "pros/imu.hpp"
+#include "slip_detector.h"
 #include "tracking_wheel.h"
+#include "utils/matrix.h"
 #include "utils/pose.h"
+#include "utils/mpsc_queue.h"
+#include "utils/seqlock.h"
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
 #include <vector>
 
+// Scalar runs independent per-axis filters. Ekf runs a 3-state extended
+// Kalman filter over (x, y, heading): tracking wheels drive the motion model
+// (r_translation is then variance per unit of travel) and the IMU heading is
+// the measurement.
+enum class OdometryFilter {
+    Scalar,
+    Ekf
+};
+
+struct TrackingWheelData {
+    double distance;
+    double total;
+    double offset;
+};
+
+// An absolute observation captured at timestamp_us (pros::micros()). Any
+// subset of the components may be present.
+struct PoseMeasurement {
+    uint64_t timestamp_us;
+    std::optional<double> x;
+    std::optional<double> y;
+    std::optional<double> heading;
+    double variance_xy;
+    double variance_heading;
+    // Squared Mahalanobis distance above which the measurement is rejected as
+    // an outlier; 0 disables gating.
+    double gate = 0;
+};
+
+struct GpsConfig {
+    double units_per_meter = 39.3701;
+    uint32_t period_ms = 20;
+    uint32_t latency_ms = 0;
+    double variance_heading = 0.0025;
+    double gate = 11.34; // chi-squared, 3 dof, 99%
+};
+
+struct MeasurementStats {
+    uint32_t accepted;
+    uint32_t rejected;
+};
+
+// Fault tracking for one sensor. A failed sensor is left out of fusion until
+// Odometry::reset().
+struct SensorStatus {
+    bool healthy = true;
+    bool needs_resync = false;
+    uint32_t errors = 0;      // PROS_ERR / non-finite readings
+    uint32_t jumps = 0;       // deltas faster than the robot can move, since reset
+    uint32_t stuck = 0;       // frozen while a same-axis peer kept moving
+    uint32_t still_ticks = 0;
+};
+
+struct HealthConfig {
+    double max_wheel_speed = 200;     // distance units per second
+    uint32_t max_jumps = 3;
+    uint32_t stuck_ticks = 25;
+    double stuck_peer_motion = 0.02;  // peer travel per tick that counts as moving
+};
+
+// Innovation-based adaptation of r_translation, r_heading and q. Heading
+// innovations (IMU against the wheel/predicted heading) drive r_heading and
+// q; disagreement between same-axis wheels drives r_translation. Each term
+// follows an exponential average of its estimates, moves by at most
+// max_rate (fractional) per tick and stays within [min_scale, max_scale] of
+// its constructor value.
+struct NoiseAdaptation {
+    bool enabled = false;
+    double window = 100;   // samples
+    double max_rate = 0.02;
+    double min_scale = 0.25;
+    double max_scale = 16;
+};
+
+struct NoiseEstimate {
+    double r_translation;
+    double r_heading;
+    double q;
+};
+
+// Device update periods. A device is re-read every tick until it returns a
+// new value, then left alone until its period has passed again, so reads
+// lock onto the device's own update phase.
+struct SampleSchedule {
+    uint32_t rotation_period_ms = 5;
+    uint32_t imu_period_ms = 10;
+    uint32_t motor_period_ms = 10;
+};
+
+struct SampleStats {
+    uint32_t reads = 0;
+    // Reads that repeated the previous value: stale ratio is duplicates /
+    // reads. A sensor that is genuinely not moving also repeats.
+    uint32_t duplicates = 0;
+    uint64_t last_fresh_us = 0;
+};
+
+class OdometryRecorder;
+struct OdometryLogHeader;
+struct OdometryLogRecord;
+
 class Odometry {
     public:
-    
+        // Sensor storage is fixed at compile time so update() never touches the heap.
+        // Sensors beyond these capacities (per axis, for wheels) are ignored;
+        // the constructor reports how many in Health::ignored_sensors and on
+        // stderr.
+        static constexpr std::size_t max_imus = 4;
+        static constexpr std::size_t max_wheels = 4;
+
+        struct LateralData {
+            std::array<TrackingWheelData, max_wheels> wheels;
+            std::size_t count = 0;
+        };
+
+        struct Health {
+            std::array<SensorStatus, max_wheels> v_wheels;
+            std::array<SensorStatus, max_wheels> h_wheels;
+            std::array<SensorStatus, max_imus> imus;
+            SensorStatus drive;
+            std::size_t ignored_sensors = 0;
+        };
+
+        struct Sampling {
+            std::array<SampleStats, max_wheels> v_wheels;
+            std::array<SampleStats, max_wheels> h_wheels;
+            std::array<SampleStats, max_imus> imus;
+            SampleStats drive;
+        };
+
+        // Raw readings consumed by one tick: Rotation::get_position() ticks,
+        // IMU::get_heading() degrees and median drive motor degrees per side
+        // (left, right). imu_accels (horizontal acceleration, g) is only
+        // sampled while slip detection is on and is not recorded.
+        //
+        // Bit i of v_stale/h_stale/imu_stale marks v_ticks[i]/h_ticks[i]/
+        // imu_headings[i] as a repeat of an earlier reading; the tracking
+        // wheels, drive encoders and EKF heading update skip stale values.
+        // Of those, v_repeat/h_repeat/drive_repeat mark the ones read this
+        // tick that returned the same value, as opposed to not being due:
+        // the wheel stuck check counts a repeat as no travel. The
+        // *_sample_us fields hold when each value was read; the wheel and
+        // drive speed checks measure a fresh delta from the sensor's
+        // previous read, fresh or repeated, and slip detection from its
+        // previous fresh sample.
+        struct Inputs {
+            uint64_t timestamp_us;
+            std::array<int32_t, max_wheels> v_ticks;
+            std::array<int32_t, max_wheels> h_ticks;
+            std::array<double, max_imus> imu_headings;
+            std::array<double, 2> drive_degrees;
+            std::array<double, max_imus> imu_accels;
+            uint8_t v_stale;
+            uint8_t h_stale;
+            uint8_t imu_stale;
+            bool drive_stale;
+            uint8_t v_repeat;
+            uint8_t h_repeat;
+            bool drive_repeat;
+            std::array<uint64_t, max_wheels> v_sample_us;
+            std::array<uint64_t, max_wheels> h_sample_us;
+            std::array<uint64_t, max_imus> imu_sample_us;
+            uint64_t drive_sample_us;
+        };
+
         Odometry(
             std::vector<pros::IMU*> imus, 
             std::vector<TrackingWheel*> v_wheels,
@@ -21,12 +197,120 @@ class Odometry {
             double q
         );
 
+        // Samples the devices and runs one tick.
         void update(Pose& pose);
 
+        // The device-free filter step; also used to replay recorded inputs.
+        void update(Pose& pose, const Inputs& inputs);
+
+        // Reads every device that is due under the sample schedule; the
+        // rest carry their previous value, flagged stale.
+        Inputs sample();
+
+        // Applies the data rates to the Rotation sensors and IMUs. Call
+        // before the odometry task starts.
+        void set_sample_schedule(const SampleSchedule& schedule);
+
+        // Sample counts as of the last tick. Safe to read from any task.
+        Sampling get_sampling() const;
+
+        // Streams the run (see odometry_log.h) to the recorder; nullptr stops.
+        // Safe while the odometry task runs: once it returns, the task no
+        // longer touches the previous recorder.
+        void set_recorder(OdometryRecorder* recorder);
+
+        OdometryLogHeader get_log_header() const;
+
+        // Re-anchors the absolute heading sources, drops pose history and
+        // returns failed sensors to service.
+        void reset(const Pose& pose);
+
+        // Queues a (possibly late) measurement; any number of tasks may call
+        // this concurrently. It is applied at its capture time on the next
+        // update() and the correction carried forward to the current pose.
+        // Returns false if the queue is full.
+        bool submit_measurement(const PoseMeasurement& measurement);
+
+        // Fuses a GPS as an absolute source at its own data rate. Position noise
+        // comes from get_error() on every sample. The GPS frame is assumed to
+        // match the frame poses are set in.
+        void set_gps(pros::Gps* gps, GpsConfig config = {});
+
+        // Safe to read from any task.
+        MeasurementStats get_measurement_stats() const;
+
+        // Wheel/IMU-only pose that absolute corrections never touch, for
+        // consumers that need raw relative motion. Safe to read from any task.
+        Pose get_dead_reckoned_pose() const;
+
+        // Call after update() while disabled. If the tracking wheels did not
+        // move and the drive motors are stopped, samples the IMUs to learn
+        // their drift; the correction is applied to every later heading.
+        void learn_imu_drift(bool motors_still);
+
+        ImuDrift get_imu_drift(std::size_t index) const;
+
+        // Call before the odometry task starts. Recordings capture the drift
+        // in their header and log what learn_imu_drift() learns after it.
+        void set_imu_drift(std::size_t index, const ImuDrift& drift);
+
+        void set_filter(OdometryFilter filter);
+
+        void set_integrator(PoseIntegrator integrator);
+
+        // Drive motor encoders stand in for the vertical tracking wheels when
+        // none are healthy, and for heading when neither the IMUs nor the
+        // horizontal wheels provide one. Set before the odometry task starts.
+        void set_drive_encoders(DriveEncoders* drive_encoders);
+
+        void set_health_config(const HealthConfig& config);
+
+        // Sensor status as of the last tick or reset(). Safe to read from
+        // any task.
+        Health get_health() const;
+
+        Mat3 get_covariance() const;
+
+        void set_noise_adaptation(const NoiseAdaptation& config);
+
+        // Compares the drive encoders (see set_drive_encoders) with the
+        // vertical tracking wheels over each drive encoder update. Needs both.
+        void set_slip_detection(const SlipConfig& config);
+
+        // Latest slip estimate. Safe to read from any task.
+        SlipEstimate get_slip() const;
+
+        // Noise terms currently in use. Safe to read from any task.
+        NoiseEstimate get_noise() const;
+
     private:
-        std::vector<pros::IMU*> imus;
-        std::vector<TrackingWheel*> v_wheels;
-        std::vector<TrackingWheel*> h_wheels;
+        void update_pose(Pose& pose, const Inputs& inputs, double dt);
+
+        void update_ekf(Pose& pose, const Inputs& inputs, const LateralData& h_wheel_data, const LateralData& v_wheel_data,
+                        const std::optional<double>& wheel_heading, const std::optional<double>& drive_heading);
+
+        bool fuse_measurement(Pose& pose, const PoseMeasurement& measurement);
+
+        std::optional<PoseMeasurement> sample_gps(uint64_t timestamp_us);
+
+        void set_covariance(const Mat3& covariance);
+
+        void detect_slip(const Inputs& inputs, double d_theta);
+
+        void adapt_noise(const std::optional<double>& r_translation_sample, const std::optional<double>& r_heading_sample,
+                         const std::optional<double>& q_sample);
+
+        bool recording() const;
+
+        void log_record(const OdometryLogRecord& record);
+
+        std::array<pros::IMU*, max_imus> imus{};
+        std::array<TrackingWheel*, max_wheels> v_wheels{};
+        std::array<TrackingWheel*, max_wheels> h_wheels{};
+        std::size_t imu_count;
+        std::size_t v_wheel_count;
+        std::size_t h_wheel_count;
+        DriveEncoders* drive_encoders = nullptr;
 
         double p_x;
         double p_y;
@@ -34,6 +318,78 @@ class Odometry {
         double r_translation;
         double r_heading;
         double q;
+
+        NoiseAdaptation noise_adaptation;
+        NoiseEstimate nominal_noise;
+        NoiseEstimate noise_average;
+        SeqLock<NoiseEstimate> noise{{0, 0, 0}};
+
+        double heading_offset = 0;
+        double last_raw_heading = 0;
+
+        OdometryFilter filter = OdometryFilter::Scalar;
+        PoseIntegrator integrator = PoseIntegrator::AverageHeading;
+        Mat3 covariance;
+        std::optional<double> last_wheel_heading;
+        std::optional<double> held_wheel_heading;
+        std::optional<double> last_imu_heading;
+        std::optional<double> last_drive_heading;
+
+        PoseHistory history;
+        MpscQueue<PoseMeasurement, 8> measurements;
+        MeasurementStats measurement_stats = {};
+        SeqLock<MeasurementStats> measurement_stats_snapshot{{0, 0}};
+
+        pros::Gps* gps = nullptr;
+        GpsConfig gps_config;
+        uint64_t last_gps_us = 0;
+
+        SeqLock<Pose> dead_reckoning{{0.0f, 0.0f, 0.0f}};
+
+        static_assert(ImuDriftEstimator::max_imus >= max_imus);
+        ImuDriftEstimator imu_drift;
+        std::array<double, max_imus> imu_drift_correction{};
+        uint64_t last_update_us = 0;
+        double last_wheel_motion = 0;
+
+        // Swapped by other tasks; recorder_busy covers a log_record() call
+        // in flight so set_recorder() can wait it out.
+        std::atomic<OdometryRecorder*> recorder{nullptr};
+        std::atomic<bool> recorder_busy{false};
+
+        SlipConfig slip_config;
+        SlipDetector slip_detector;
+        SeqLock<SlipEstimate> slip{{0, 0, 0, false}};
+        LateralData tracked_verticals;
+        bool drive_usable = false;
+        bool drive_sampled = false;
+
+        // Tracking wheel motion since the last fresh drive encoder sample.
+        struct SlipWindow {
+            uint64_t start_us = 0;
+            double travel = 0;
+            double turn = 0;
+            bool tracked = false;
+        };
+        SlipWindow slip_window;
+
+        // Working copies, touched only by the odometry task; the SeqLocks
+        // publish them once per tick.
+        Health health = {};
+        SeqLock<Health> health_snapshot{Health{}};
+        HealthConfig health_config;
+
+        SampleSchedule schedule;
+        Sampling sampling = {};
+        SeqLock<Sampling> sampling_snapshot{Sampling{}};
+        Inputs last_inputs = {};
+        std::array<uint64_t, max_wheels> v_due{};
+        std::array<uint64_t, max_wheels> h_due{};
+        std::array<uint64_t, max_imus> imu_due{};
+        uint64_t drive_due = 0;
+        std::array<uint64_t, max_wheels> v_read_us{};
+        std::array<uint64_t, max_wheels> h_read_us{};
+        uint64_t drive_read_us = 0;
 };
 
-#endif
\ No newline at end of file
+#endif
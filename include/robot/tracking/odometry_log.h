@@ -0,0 +1,94 @@
+#ifndef ODOMETRY_LOG_H
+#define ODOMETRY_LOG_H
+
+#include "odometry.h"
+#include <array>
+#include <cstdint>
+#include <cstdio>
+
+// Binary recording of an Odometry run for replay on the host: every tick's
+// Inputs plus everything else that moves the pose, so a replay that applies
+// the records in order reproduces the live pose.
+//
+// Layout (little-endian, no padding):
+//   header: "ODLG", u16 version, u8 imu/v/h counts, u8 filter,
+//           u8 has_drive (v2),
+//           f64 diameter+offset per wheel, f64 drift rate per IMU,
+//           f64 wheel_diameter gear_ratio track_width if has_drive,
+//           f64 p_x p_y p_theta r_translation r_heading q,
+//           u8 integrator, u8 adaptation enabled, f64 window max_rate
+//           min_scale max_scale, f64 max_wheel_speed, u32 max_jumps
+//           stuck_ticks, f64 stuck_peer_motion (v4)
+//   record: u8 event (v4), then by event:
+//     Inputs:      u64 timestamp_us, i32 tick per v then h wheel,
+//                  f64 heading per IMU, f64 left right drive degrees if
+//                  has_drive, u8 v_stale h_stale imu_stale drive_stale (v3),
+//                  u8 v_repeat h_repeat drive_repeat (v6)
+//     Reset:       f64 x y heading
+//     Measurement: u64 timestamp_us, u8 bits for x y heading present, f64
+//                  per present component, f64 variance_xy variance_heading
+//                  gate
+//     ImuDrift:    u8 imu, f64 rate learned_s (v4 had gyro_bias between)
+//     Dropped:     u32 records lost since the last Dropped record
+// Only the sensors that are present are stored. Older versions are still
+// read as Inputs records; before v3 their readings are all treated as fresh.
+// Before v6, stale readings are all treated as not due.
+//
+// A tick's records are written in the order the live run applied them:
+// resets, then the measurements fused during the tick, then its Inputs, then
+// any IMU drift learned after it. A replay submits measurements and runs
+// update() on Inputs, which fuses them after integrating just as live.
+
+enum class OdometryLogEvent : uint8_t {
+    Inputs,
+    Reset,
+    Measurement,
+    ImuDrift,
+    Dropped
+};
+
+// Only the fields for `event` are meaningful.
+struct OdometryLogRecord {
+    OdometryLogEvent event = OdometryLogEvent::Inputs;
+    Odometry::Inputs inputs = {};
+    Pose pose;
+    PoseMeasurement measurement = {};
+    uint8_t imu = 0;
+    ImuDrift drift = {};
+    uint32_t dropped = 0;
+};
+
+struct WheelGeometry {
+    double diameter;
+    double offset;
+};
+
+struct OdometryLogHeader {
+    uint16_t version; // set by read_log_header(); writing always uses the current version
+    uint8_t imu_count;
+    uint8_t v_wheel_count;
+    uint8_t h_wheel_count;
+    uint8_t filter;
+    uint8_t has_drive;
+    std::array<WheelGeometry, Odometry::max_wheels> v_wheels;
+    std::array<WheelGeometry, Odometry::max_wheels> h_wheels;
+    std::array<double, Odometry::max_imus> imu_drift_rates;
+    DriveEncoderConfig drive;
+    double p_x;
+    double p_y;
+    double p_theta;
+    double r_translation;
+    double r_heading;
+    double q;
+    uint8_t integrator;
+    NoiseAdaptation noise_adaptation;
+    HealthConfig health;
+};
+
+bool write_log_header(std::FILE* file, const OdometryLogHeader& header);
+bool write_log_record(std::FILE* file, const OdometryLogHeader& header, const OdometryLogRecord& record);
+
+bool read_log_header(std::FILE* file, OdometryLogHeader& header);
+bool read_log_record(std::FILE* file, const OdometryLogHeader& header, OdometryLogRecord& record);
+
+#endif // ODOMETRY_LOG_H
@@ -0,0 +1,52 @@
+#ifndef ODOMETRY_RECORDER_H
+#define ODOMETRY_RECORDER_H
+
+#include "odometry.h"
+#include "odometry_log.h"
+#include "pros/rtos.hpp"
+#include "utils/spsc_queue.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <optional>
+
+// Writes an Odometry run (see odometry_log.h) to the SD card from a
+// low-priority task so the odometry tick never waits on file I/O. Records
+// are dropped if the writer falls behind; the count goes into the log as a
+// Dropped record, which a replay treats as fatal.
+class OdometryRecorder {
+    public:
+        // Opens `path` (e.g. "/usd/odom.bin"), writes the header and starts
+        // recording. Attach before Chassis::start_odometry() for a replay that
+        // starts from the same state as the live run.
+        bool start(Odometry* odometry, const char* path);
+
+        // Detaches from the odometry and returns once every queued record is
+        // written and the file closed, after which the recorder may be
+        // destroyed or started again.
+        void stop();
+
+        // Queues a record. Only the odometry task may call this. Defined
+        // here so the host build of odometry.cpp links without the writer.
+        void record(const OdometryLogRecord& record) {
+            if (!queue.push(record)) dropped.fetch_add(1, std::memory_order_relaxed);
+        }
+
+        uint32_t get_dropped() const;
+
+    private:
+        void writer_loop();
+
+        void write_dropped();
+
+        Odometry* odometry = nullptr;
+        std::FILE* file = nullptr;
+        OdometryLogHeader header = {};
+        SpscQueue<OdometryLogRecord, 64> queue;
+        std::atomic<bool> running{false};
+        std::atomic<uint32_t> dropped{0};
+        uint32_t dropped_written = 0;
+        std::optional<pros::Task> task;
+};
+
+#endif // ODOMETRY_RECORDER_H
@@ -0,0 +1,50 @@
+#ifndef POSE_HISTORY_H
+#define POSE_HISTORY_H
+
+#include "utils/matrix.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+struct PoseSample {
+    uint64_t timestamp_us;
+    Vec3 state;
+    Mat3 covariance;
+};
+
+// Fixed-capacity ring of timestamped poses, oldest overwritten first.
+// Timestamps must be pushed in increasing order.
+class PoseHistory {
+    public:
+        static constexpr std::size_t capacity = 128;
+
+        void push(uint64_t timestamp_us, const Vec3& state, const Mat3& covariance);
+
+        // Binary search plus linear interpolation between the bracketing
+        // samples. Empty if the timestamp is older than the oldest sample;
+        // clamps to the newest sample if it is in the future.
+        std::optional<PoseSample> at(uint64_t timestamp_us) const;
+
+        // Re-expresses every sample newer than timestamp_us relative to a
+        // corrected pose at that time, so later lookups see the correction.
+        void apply_correction(uint64_t timestamp_us, const Vec3& before, const Vec3& after, const Mat3& covariance_reduction);
+
+        std::optional<PoseSample> newest() const;
+        std::size_t size() const;
+        void clear();
+
+    private:
+        const PoseSample& get(std::size_t index) const;
+        PoseSample& get(std::size_t index);
+        std::size_t lower_bound(uint64_t timestamp_us) const;
+
+        std::array<PoseSample, capacity> samples{};
+        std::size_t start = 0;
+        std::size_t count = 0;
+};
+
+// Moves `pose` rigidly so that `before` maps onto `after`.
+Vec3 transfer_pose(const Vec3& pose, const Vec3& before, const Vec3& after);
+
+#endif // POSE_HISTORY_H
@@ -0,0 +1,26 @@
+#ifndef POSE_INTEGRATOR_H
+#define POSE_INTEGRATOR_H
+
+#include "utils/matrix.h"
+
+// AverageHeading rotates each wheel's arc chord by the mid-tick heading (the
+// original update_global_pose path). Exponential composes the pose with the
+// SE(2) exponential of the tick's body twist.
+enum class PoseIntegrator {
+    AverageHeading,
+    Exponential
+};
+
+// Body-frame motion over one tick: arc lengths travelled by the tracking
+// centre along x (forward) and y, and the heading change.
+struct Twist {
+    double dx;
+    double dy;
+    double dtheta;
+};
+
+// Exact for a twist that is constant over the tick; the heading is left
+// unwrapped.
+Vec3 integrate_exponential(const Vec3& pose, const Twist& twist);
+
+#endif // POSE_INTEGRATOR_H
@@ -0,0 +1,38 @@
+#ifndef SLIP_DETECTOR_H
+#define SLIP_DETECTOR_H
+
+#include <cstdint>
+
+struct SlipConfig {
+    bool enabled = false;
+    double threshold = 0.5;   // smoothed slip ratio that counts as slipping
+    double min_speed = 5;     // drive side speed (distance units/s) below which nothing is flagged
+    double accel_gate = 0.3;  // horizontal IMU acceleration (g) above which the robot is
+                              // accelerating, so still tracking wheels are not trusted
+    double window = 10;       // smoothing, in drive encoder updates
+};
+
+struct SlipEstimate {
+    double left;    // per-side slip ratio this update, 0 (grip) to 1 (spinning freely)
+    double right;
+    double ratio;   // smoothed max of the two sides
+    bool slipping;
+};
+
+// Compares each drive side's travel with what the tracking wheels and heading
+// change say that side should have travelled. A handful of flops per update.
+class SlipDetector {
+    public:
+        // Travel over the same `dt` seconds: `left`/`right` from the drive
+        // encoders and `expected_left`/`expected_right` from the tracking
+        // wheels.
+        SlipEstimate update(double left, double right, double expected_left, double expected_right,
+                            double accel, double dt, const SlipConfig& config);
+
+        void reset();
+
+    private:
+        double ratio = 0;
+};
+
+#endif // SLIP_DETECTOR_H
@@ -2,19 +2,43 @@
 #define TRACKING_WHEEL_H
 
 #include "pros/rotation.hpp"
+#include <cstdint>
 
+// `offset` is signed so that turning in place by theta (radians, clockwise
+// positive) moves the wheel by -offset * theta. That makes it the distance
+// to the right of the tracking centre for a vertical wheel, and the distance
+// behind it for a horizontal wheel (positive travel to the right). Every
+// Odometry formula and WheelCalibration::fit() use this convention.
 class TrackingWheel {
     public:
         TrackingWheel(pros::Rotation* encoder, float diameter, double offset);
+        // Accumulates a raw Rotation::get_position() reading. The first
+        // reading only sets the reference.
+        void set_position(int32_t position);
+        // Takes `position` as the new reference without producing a delta.
+        void resync(int32_t position);
+        // Ticks `position` is from the last accepted reading (0 if unprimed).
+        int32_t peek_delta(int32_t position) const;
+        double ticks_to_distance(int64_t ticks) const;
         double get_distance_delta();
         double get_distance_total();
         double get_offset();
+        double get_diameter();
+        void set_offset(double offset);
+        void set_diameter(double diameter);
+        pros::Rotation* get_encoder();
         
     private:
+        // Multi-turn position is accumulated in raw centidegree ticks and only
+        // converted to distance on the way out, so deltas are exact.
+
         pros::Rotation* encoder;
-        float diameter;
-        float offset;
-        float last_total;
+        double diameter;
+        double offset;
+        bool primed = false;
+        int32_t last_position = 0;
+        int64_t total_ticks = 0;
+        int64_t last_total_ticks = 0;
 };
 
-#endif // TRACKING_WHEEL_H
\ No newline at end of file
+#endif // TRACKING_WHEEL_H
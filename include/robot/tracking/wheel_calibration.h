@@ -0,0 +1,97 @@
+#ifndef WHEEL_CALIBRATION_H
+#define WHEEL_CALIBRATION_H
+
+#include "pros/imu.hpp"
+#include "tracking_wheel.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+class Chassis;
+
+enum class TrackingAxis {
+    Vertical,
+    Horizontal
+};
+
+struct WheelFit {
+    double diameter;
+    double offset;
+    double rms_error; // spin fit residual, distance units
+};
+
+// Fits tracking wheel diameters and offsets from two kinds of run:
+//   - spins in place, where each wheel travels -offset * heading (clockwise
+//     radians, see TrackingWheel) against the IMU;
+//   - straight runs over a known distance along one axis.
+// Everything recorded is fitted at once by least squares. Diameters come
+// from the straight runs (the current value is kept for an axis without
+// one), then offsets from the spin samples.
+class WheelCalibration {
+    public:
+        static constexpr std::size_t max_wheels = 4;
+        static constexpr std::size_t max_spin_samples = 4096;
+        static constexpr std::size_t max_straight_runs = 16;
+
+        WheelCalibration(pros::IMU* imu, std::vector<TrackingWheel*> v_wheels, std::vector<TrackingWheel*> h_wheels);
+
+        // Blocks while the chassis spins `turns` times in place, sampling
+        // every 10 ms. Returns false if the IMU stopped responding or the spin
+        // timed out; the samples taken are kept either way.
+        bool run_spin(Chassis& chassis, double turns, float power = 40.0f);
+
+        // Straight run: call begin_straight() with the robot on a start mark,
+        // move it `distance` along `axis` (sideways for horizontal wheels),
+        // then call end_straight(). Repeat runs to average them out.
+        bool begin_straight();
+        bool end_straight(TrackingAxis axis, double distance);
+
+        // Fits every recorded run and applies the result to the wheels.
+        bool fit();
+
+        WheelFit get_fit(TrackingAxis axis, std::size_t index) const;
+
+        // One "v|h <index> <diameter> <offset>" line per wheel.
+        bool save(const char* path) const;
+
+        // Raw samples as CSV, for checking a fit off the robot.
+        bool write_samples(const char* path) const;
+
+    private:
+        struct SpinSample {
+            double rotation; // IMU::get_rotation() degrees
+            std::array<int32_t, max_wheels> ticks;
+        };
+
+        struct StraightRun {
+            TrackingAxis axis;
+            double distance;
+            std::array<int32_t, max_wheels> ticks;
+        };
+
+        bool read_ticks(std::array<int32_t, max_wheels>& ticks) const;
+
+        std::size_t wheel_index(TrackingAxis axis, std::size_t index) const;
+
+        pros::IMU* imu;
+        std::array<TrackingWheel*, max_wheels> wheels{};
+        std::array<TrackingAxis, max_wheels> axes{};
+        std::size_t wheel_count = 0;
+        std::size_t v_wheel_count = 0;
+
+        std::vector<SpinSample> spin_samples;
+        std::vector<std::size_t> spin_starts;
+        std::vector<StraightRun> straight_runs;
+        std::array<int32_t, max_wheels> straight_start{};
+        bool straight_started = false;
+
+        std::array<WheelFit, max_wheels> fits{};
+};
+
+// Applies a file written by WheelCalibration::save(). Call from initialize(),
+// before odometry starts. Returns false if the file is missing or malformed,
+// in which case no wheel is changed.
+bool load_wheel_calibration(const char* path, std::vector<TrackingWheel*> v_wheels, std::vector<TrackingWheel*> h_wheels);
+
+#endif // WHEEL_CALIBRATION_H
@@ -1,11 +1,16 @@
 #ifndef ANGLE_H
 #define ANGLE_H
 #include <cmath>
+#include <cstdint>
 
+// Constant time: subtracts the nearest whole number of turns instead of
+// looping. Angles too large for that (and NaN or infinity, which come back
+// as NaN) go through std::remainder instead.
 inline double wrap_angle(double angle) {
-    while (angle > M_PI) angle -= 2*M_PI;
-    while (angle < -M_PI) angle += 2*M_PI;
-    return angle;
+    const double turns = angle * (0.5 / M_PI);
+    if (!(std::abs(turns) < 1e9)) return std::remainder(angle, 2 * M_PI);
+    const int32_t whole = static_cast<int32_t>(turns + (turns >= 0 ? 0.5 : -0.5));
+    return angle - whole * (2 * M_PI);
 }
 
 inline double to_radians(double angle) {
@@ -1,6 +0,0 @@
-#ifndef CHECK_THRESHOLD_H
-#define CHECK_THRESHOLD_H
-
-float check_threshold(float value, float min_value);
-
-#endif
\ No newline at end of file
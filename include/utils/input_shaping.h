@@ -0,0 +1,87 @@
+#ifndef INPUT_SHAPING_H
+#define INPUT_SHAPING_H
+
+#include <array>
+#include <cstddef>
+
+// Joystick response curves, in controller units (-127 to 127). A curve is a
+// table of outputs for inputs 0..127 built at compile time; shape() indexes
+// it and interpolates, mirroring for negative inputs.
+
+inline constexpr float JOYSTICK_MAX = 127.0f;
+
+using CurveTable = std::array<float, 128>;
+
+namespace input_shaping_detail {
+    // exp() is not constexpr until C++26: halve the argument below 0.5,
+    // take a Taylor series and square back up.
+    constexpr double exp(double x) {
+        int halvings = 0;
+        while (x > 0.5 || x < -0.5) {
+            x /= 2;
+            halvings++;
+        }
+        double term = 1, sum = 1;
+        for (int n = 1; n < 16; n++) {
+            term *= x / n;
+            sum += term;
+        }
+        while (halvings--) sum *= sum;
+        return sum;
+    }
+}
+
+constexpr CurveTable make_linear_curve() {
+    CurveTable table{};
+    for (std::size_t i = 0; i < table.size(); i++) table[i] = static_cast<float>(i);
+    return table;
+}
+
+// Flattens the low end while still reaching full output at full stick;
+// gain 0 is linear. f(x) = (e^(-g/10) + e^((x - 127)/10) (1 - e^(-g/10))) x
+constexpr CurveTable make_exponential_curve(double gain) {
+    CurveTable table{};
+    const double floor = input_shaping_detail::exp(-gain / 10);
+    for (std::size_t i = 0; i < table.size(); i++) {
+        const double x = static_cast<double>(i);
+        table[i] = static_cast<float>((floor + input_shaping_detail::exp((x - JOYSTICK_MAX) / 10) * (1 - floor)) * x);
+    }
+    return table;
+}
+
+// Blend of cubic and linear: weight 0 is linear, 1 is a pure cubic.
+constexpr CurveTable make_cubic_curve(double weight) {
+    CurveTable table{};
+    for (std::size_t i = 0; i < table.size(); i++) {
+        const double x = static_cast<double>(i) / JOYSTICK_MAX;
+        table[i] = static_cast<float>((weight * x * x * x + (1 - weight) * x) * JOYSTICK_MAX);
+    }
+    return table;
+}
+
+inline constexpr CurveTable LINEAR_CURVE = make_linear_curve();
+inline constexpr CurveTable EXPONENTIAL_CURVE = make_exponential_curve(6.0);
+inline constexpr CurveTable CUBIC_CURVE = make_cubic_curve(0.7);
+
+// A driver's preferences. Tables must outlive the profile; the predefined
+// ones above (or any other constexpr table) do.
+struct DriveProfile {
+    const CurveTable* throttle = &LINEAR_CURVE;
+    const CurveTable* turn = &LINEAR_CURVE;
+    float turn_sensitivity = 1.0f; // curvature drive: turn per unit throttle
+};
+
+// Table lookup with linear interpolation; |value| is clamped to 127.
+float shape(const CurveTable& curve, float value);
+
+// Deadzones that rescale what is left of the range back to 0..127, so output
+// starts from zero at the edge instead of jumping to the threshold.
+float scaled_deadzone(float value, float deadzone);
+
+// Applies the deadzone to the stick's magnitude, keeping its direction.
+void radial_deadzone(float& x, float& y, float deadzone);
+
+// Scales both sides down together if either exceeds full output.
+void desaturate(float& left, float& right);
+
+#endif
@@ -0,0 +1,104 @@
+#ifndef MATRIX_H
+#define MATRIX_H
+
+#include <array>
+#include <cstddef>
+
+// Fixed-size 3x3 kernel for the (x, y, heading) filter. Everything lives on
+// the stack and the loops have constant trip counts, so the compiler fully
+// unrolls them.
+using Vec3 = std::array<double, 3>;
+
+struct Mat3 {
+    std::array<std::array<double, 3>, 3> m{};
+
+    static constexpr Mat3 identity() {
+        Mat3 result;
+        for (std::size_t i = 0; i < 3; i++) result.m[i][i] = 1;
+        return result;
+    }
+
+    static constexpr Mat3 diagonal(double a, double b, double c) {
+        Mat3 result;
+        result.m[0][0] = a;
+        result.m[1][1] = b;
+        result.m[2][2] = c;
+        return result;
+    }
+
+    constexpr double& operator()(std::size_t row, std::size_t col) { return m[row][col]; }
+    constexpr double operator()(std::size_t row, std::size_t col) const { return m[row][col]; }
+};
+
+constexpr Mat3 operator+(const Mat3& a, const Mat3& b) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = a.m[i][j] + b.m[i][j];
+    return result;
+}
+
+constexpr Mat3 operator-(const Mat3& a, const Mat3& b) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = a.m[i][j] - b.m[i][j];
+    return result;
+}
+
+constexpr Mat3 operator*(const Mat3& a, const Mat3& b) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = a.m[i][0] * b.m[0][j] + a.m[i][1] * b.m[1][j] + a.m[i][2] * b.m[2][j];
+    return result;
+}
+
+constexpr Mat3 operator*(double scale, const Mat3& a) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = scale * a.m[i][j];
+    return result;
+}
+
+constexpr Mat3 transpose(const Mat3& a) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = a.m[j][i];
+    return result;
+}
+
+// a * p * a^T, the covariance propagation step.
+constexpr Mat3 sandwich(const Mat3& a, const Mat3& p) {
+    return a * p * transpose(a);
+}
+
+constexpr Mat3 symmetrize(const Mat3& a) {
+    Mat3 result;
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            result.m[i][j] = 0.5 * (a.m[i][j] + a.m[j][i]);
+    return result;
+}
+
+// Kalman update for a measurement of a single state component (H is a unit
+// row), avoiding any matrix inverse. Returns false if the innovation
+// variance is degenerate.
+constexpr bool scalar_update(Vec3& x, Mat3& p, std::size_t index, double innovation, double r) {
+    const double s = p.m[index][index] + r;
+    if (s <= 0) return false;
+
+    Vec3 k{};
+    for (std::size_t i = 0; i < 3; i++) k[i] = p.m[i][index] / s;
+    for (std::size_t i = 0; i < 3; i++) x[i] += k[i] * innovation;
+
+    const std::array<double, 3> row = p.m[index];
+    for (std::size_t i = 0; i < 3; i++)
+        for (std::size_t j = 0; j < 3; j++)
+            p.m[i][j] -= k[i] * row[j];
+    return true;
+}
+
+#endif // MATRIX_H
@@ -0,0 +1,66 @@
+#ifndef MPSC_QUEUE_H
+#define MPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+
+// Fixed-capacity lock-free queue for handing data from any number of
+// producer tasks to one consumer task. Producers claim a slot with a
+// compare-and-swap, so none of them waits on another; a producer preempted
+// between claiming and filling its slot only holds the consumer back at that
+// slot until it resumes. Capacity must be a power of two.
+template <typename T, std::size_t Capacity>
+class MpscQueue {
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "MpscQueue capacity must be a power of two");
+
+    public:
+        MpscQueue() {
+            for (std::size_t i = 0; i < Capacity; i++) cells[i].sequence.store(i, std::memory_order_relaxed);
+        }
+
+        // Returns false if the queue is full.
+        bool push(const T& item) {
+            std::size_t position = write_index.load(std::memory_order_relaxed);
+            Cell* cell;
+            while (true) {
+                cell = &cells[position & (Capacity - 1)];
+                const std::size_t sequence = cell->sequence.load(std::memory_order_acquire);
+                const intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+                if (difference == 0) {
+                    if (write_index.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) break;
+                } else if (difference < 0) {
+                    return false;
+                } else {
+                    position = write_index.load(std::memory_order_relaxed);
+                }
+            }
+            cell->item = item;
+            cell->sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer only.
+        std::optional<T> pop() {
+            Cell& cell = cells[read_index & (Capacity - 1)];
+            if (cell.sequence.load(std::memory_order_acquire) != read_index + 1) return std::nullopt;
+            T item = cell.item;
+            cell.sequence.store(read_index + Capacity, std::memory_order_release);
+            read_index++;
+            return item;
+        }
+
+    private:
+        struct Cell {
+            std::atomic<std::size_t> sequence;
+            T item{};
+        };
+
+        std::array<Cell, Capacity> cells;
+        std::atomic<std::size_t> write_index{0};
+        std::size_t read_index = 0;
+};
+
+#endif // MPSC_QUEUE_H
@@ -6,6 +6,8 @@ struct Pose {
     float y;
     float heading;
 
+    Pose ();
+
     Pose (float x, float y, float heading);
 };
 
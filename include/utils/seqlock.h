@@ -0,0 +1,41 @@
+#ifndef SEQLOCK_H
+#define SEQLOCK_H
+
+#include <atomic>
+#include <cstdint>
+#include <type_traits>
+
+// Single-writer, multi-reader snapshot. The writer never blocks; readers
+// retry if the writer published while they were copying, so the writer must
+// run at a priority at least as high as every reader.
+template <typename T>
+class SeqLock {
+    static_assert(std::is_trivially_copyable_v<T>, "SeqLock requires a trivially copyable type");
+
+    public:
+        explicit SeqLock(const T& value) : value(value) {}
+
+        void store(const T& new_value) {
+            const uint32_t seq = sequence.load(std::memory_order_relaxed);
+            sequence.store(seq + 1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+            value = new_value;
+            sequence.store(seq + 2, std::memory_order_release);
+        }
+
+        T load() const {
+            while (true) {
+                const uint32_t before = sequence.load(std::memory_order_acquire);
+                if (before & 1) continue;
+                T copy = value;
+                std::atomic_thread_fence(std::memory_order_acquire);
+                if (sequence.load(std::memory_order_relaxed) == before) return copy;
+            }
+        }
+
+    private:
+        std::atomic<uint32_t> sequence{0};
+        T value;
+};
+
+#endif // SEQLOCK_H
@@ -0,0 +1,41 @@
+#ifndef SPSC_QUEUE_H
+#define SPSC_QUEUE_H
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <optional>
+
+// Fixed-capacity lock-free queue for handing data from one producer task to
+// one consumer task without blocking either.
+template <typename T, std::size_t Capacity>
+class SpscQueue {
+    public:
+        bool push(const T& item) {
+            const std::size_t tail = write_index.load(std::memory_order_relaxed);
+            const std::size_t next = (tail + 1) % (Capacity + 1);
+            if (next == read_index.load(std::memory_order_acquire)) return false;
+            items[tail] = item;
+            write_index.store(next, std::memory_order_release);
+            return true;
+        }
+
+        std::optional<T> pop() {
+            const std::size_t head = read_index.load(std::memory_order_relaxed);
+            if (head == write_index.load(std::memory_order_acquire)) return std::nullopt;
+            T item = items[head];
+            read_index.store((head + 1) % (Capacity + 1), std::memory_order_release);
+            return item;
+        }
+
+        bool empty() const {
+            return read_index.load(std::memory_order_acquire) == write_index.load(std::memory_order_acquire);
+        }
+
+    private:
+        std::array<T, Capacity + 1> items{};
+        std::atomic<std::size_t> read_index{0};
+        std::atomic<std::size_t> write_index{0};
+};
+
+#endif // SPSC_QUEUE_H
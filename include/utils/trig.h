@@ -0,0 +1,75 @@
+#ifndef TRIG_H
+#define TRIG_H
+
+#include <cmath>
+#include <cstdint>
+
+// Trig policies for the control loop. Both expose the same static interface,
+// so hot code calls Trig::sincos / Trig::atan2 and the implementation is
+// chosen at compile time: define FAST_TRIG (e.g. EXTRA_CXXFLAGS=-DFAST_TRIG
+// in the Makefile) to switch from libm to the polynomial kernels.
+
+struct LibmTrig {
+    static double sin(double x) { return std::sin(x); }
+    static double cos(double x) { return std::cos(x); }
+    static void sincos(double x, double& s, double& c) {
+        s = std::sin(x);
+        c = std::cos(x);
+    }
+    static double atan2(double y, double x) { return std::atan2(y, x); }
+};
+
+// Branch-light polynomial approximations with no libm calls.
+//   sin/cos/sincos: |error| < 3e-8 for |x| < 1000 (degree 9/8 Taylor on a
+//                   Cody-Waite reduced quadrant).
+//   atan2:          |error| < 2e-6 rad (degree 11 minimax atan on [0, 1]).
+struct FastTrig {
+    static void sincos(double x, double& s, double& c) {
+        const double scaled = x * (2.0 / M_PI);
+        const int32_t quadrant = static_cast<int32_t>(scaled + (scaled >= 0 ? 0.5 : -0.5));
+        const double k = quadrant;
+        const double r = (x - k * 1.5707963267341256) - k * 6.077100506506192e-11;
+        const double r2 = r * r;
+        const double sr = r + r * r2 * (-1.0 / 6 + r2 * (1.0 / 120 + r2 * (-1.0 / 5040 + r2 * (1.0 / 362880))));
+        const double cr = 1 + r2 * (-0.5 + r2 * (1.0 / 24 + r2 * (-1.0 / 720 + r2 * (1.0 / 40320))));
+        switch (quadrant & 3) {
+            case 0: s = sr; c = cr; break;
+            case 1: s = cr; c = -sr; break;
+            case 2: s = -sr; c = -cr; break;
+            default: s = -cr; c = sr; break;
+        }
+    }
+
+    static double sin(double x) {
+        double s, c;
+        sincos(x, s, c);
+        return s;
+    }
+
+    static double cos(double x) {
+        double s, c;
+        sincos(x, s, c);
+        return c;
+    }
+
+    static double atan2(double y, double x) {
+        const double ax = std::abs(x), ay = std::abs(y);
+        const double larger = ax > ay ? ax : ay;
+        const double smaller = ax > ay ? ay : ax;
+        if (larger == 0) return 0;
+        const double a = smaller / larger;
+        const double a2 = a * a;
+        double r = a * (0.99997726 + a2 * (-0.33262347 + a2 * (0.19354346 + a2 * (-0.11643287 + a2 * (0.05265332 + a2 * -0.01172120)))));
+        if (ay > ax) r = M_PI_2 - r;
+        if (x < 0) r = M_PI - r;
+        return y < 0 ? -r : r;
+    }
+};
+
+#ifdef FAST_TRIG
+using Trig = FastTrig;
+#else
+using Trig = LibmTrig;
+#endif
+
+#endif // TRIG_H
@@ -0,0 +1,38 @@
+#ifndef TRIPLE_BUFFER_H
+#define TRIPLE_BUFFER_H
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <optional>
+
+// Latest-value mailbox from one producer task to one consumer task. Each
+// store() replaces whatever the consumer has not taken yet, so the newest
+// value is never dropped and neither side ever waits: the two sides only
+// swap buffer indices through one atomic.
+template <typename T>
+class TripleBuffer {
+    public:
+        void store(const T& value) {
+            buffers[back] = value;
+            back = middle.exchange(back | FRESH, std::memory_order_acq_rel) & INDEX;
+        }
+
+        // The newest value stored since the last take(), if any.
+        std::optional<T> take() {
+            if (!(middle.load(std::memory_order_acquire) & FRESH)) return std::nullopt;
+            front = middle.exchange(front, std::memory_order_acq_rel) & INDEX;
+            return buffers[front];
+        }
+
+    private:
+        static constexpr uint8_t INDEX = 3;
+        static constexpr uint8_t FRESH = 4;
+
+        std::array<T, 3> buffers{};
+        std::atomic<uint8_t> middle{1};
+        uint8_t back = 0;  // producer side
+        uint8_t front = 2; // consumer side
+};
+
+#endif // TRIPLE_BUFFER_H
@@ -2,11 +2,17 @@
 #include "../include/utils/devices.h"
 #include "pros/misc.h"
 
-void initialize() {}
+void initialize() {
+	chassis.start_control();
+}
 
-void competition_initialize() {}
+void competition_initialize() {
+	chassis.set_imu_drift_learning(true);
+}
 
-void disabled() {}
+void disabled() {
+	chassis.set_imu_drift_learning(true);
+}
 
 void autonomous() {}
 
@@ -1,6 +1,31 @@
 #include "chassis.h"
-#include "../include/utils/check_threshold.h"
+#include "pros/error.h"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
 #include "utils/pose.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr double STILL_MOTOR_RPM = 0.5;
+// Curvature drive blends from turning in place at zero throttle to pure
+// curvature at this throttle.
+static constexpr float QUICK_TURN_THROTTLE = 10.0f;
+
+static constexpr double BATTERY_FILTER = 0.1;
+
+// Updates `stats` for a tick that started at `start_us`.
+static void record_tick(LoopStats& stats, uint32_t start_us, uint32_t& last_start_us, uint32_t period_us) {
+    const uint32_t tick_us = pros::micros() - start_us;
+    const uint32_t interval_us = start_us - last_start_us;
+    const uint32_t jitter_us = interval_us > period_us ? interval_us - period_us : period_us - interval_us;
+    last_start_us = start_us;
+
+    stats.ticks++;
+    if (tick_us >= period_us) stats.overruns++;
+    stats.last_tick_us = tick_us;
+    stats.max_tick_us = std::max(stats.max_tick_us, tick_us);
+    if (stats.ticks > 1) stats.max_jitter_us = std::max(stats.max_jitter_us, jitter_us);
+}
 
 Chassis::Chassis(std::initializer_list<int8_t> left_drive_motor_ports, 
                  std::initializer_list<int8_t> right_drive_motor_ports, 
@@ -12,14 +37,309 @@ Chassis::Chassis(std::initializer_list<int8_t> left_drive_motor_ports,
       r_deadzone(right_joystick_y_deadzone.value_or(0.0f)) {}
 
 void Chassis::tank(float left_joystick_y_position, float right_joystick_y_position) {
-    l_motors.move(check_threshold(left_joystick_y_position, l_deadzone));
-    r_motors.move(check_threshold(right_joystick_y_position, r_deadzone));
+    const float left = shape(*profile.throttle, scaled_deadzone(left_joystick_y_position, l_deadzone));
+    const float right = shape(*profile.throttle, scaled_deadzone(right_joystick_y_position, r_deadzone));
+    send_drive({DriveMode::Power, left, right, 0.0f, 0.0f});
+}
+
+void Chassis::arcade(float throttle, float turn) {
+    shape_arcade(throttle, turn);
+    float left = throttle + turn;
+    float right = throttle - turn;
+    desaturate(left, right);
+    send_drive({DriveMode::Power, left, right, 0.0f, 0.0f});
+}
+
+void Chassis::curvature(float throttle, float turn) {
+    shape_arcade(throttle, turn);
+    const float curve = std::abs(throttle) / JOYSTICK_MAX * turn * profile.turn_sensitivity;
+    const float blend = std::min(std::abs(throttle) / QUICK_TURN_THROTTLE, 1.0f);
+    const float steer = turn + (curve - turn) * blend;
+    float left = throttle + steer;
+    float right = throttle - steer;
+    desaturate(left, right);
+    send_drive({DriveMode::Power, left, right, 0.0f, 0.0f});
+}
+
+void Chassis::set_drive_profile(const DriveProfile& profile) {
+    this->profile = profile;
+}
+
+void Chassis::shape_arcade(float& throttle, float& turn) const {
+    radial_deadzone(turn, throttle, l_deadzone);
+    throttle = shape(*profile.throttle, throttle);
+    turn = shape(*profile.turn, turn);
+}
+
+void Chassis::send_drive(const DriveCommand& command) {
+    if (!control_task) {
+        write_drive(command);
+        return;
+    }
+    drive_command.store(command);
+}
+
+void Chassis::set_slip_limit(std::optional<float> max_output) {
+    slip_limit.store(max_output ? std::abs(max_output.value()) : -1.0f, std::memory_order_relaxed);
+}
+
+void Chassis::write_drive(const DriveCommand& command) {
+    if (command.mode == DriveMode::Velocity) {
+        write_velocity(command);
+    } else if (command.mode == DriveMode::Voltage) {
+        l_motors.move_voltage(static_cast<int32_t>(std::lround(command.left * 1000.0f)));
+        r_motors.move_voltage(static_cast<int32_t>(std::lround(command.right * 1000.0f)));
+    } else {
+        write_power(command.left, command.right);
+    }
+}
+
+void Chassis::write_power(float left, float right) {
+    const float limit = slip_limit.load(std::memory_order_relaxed);
+    if (limit >= 0 && odometry && odometry->get_slip().slipping) {
+        left = std::clamp(left, -limit, limit);
+        right = std::clamp(right, -limit, limit);
+    }
+    l_motors.move(left);
+    r_motors.move(right);
+}
+
+void Chassis::write_velocity(const DriveCommand& command) {
+    const int32_t battery_mv = pros::battery::get_voltage();
+    if (battery_mv != PROS_ERR && battery_mv > 0) battery_volts += BATTERY_FILTER * (battery_mv / 1000.0 - battery_volts);
+
+    auto volts = drive_feedforward(drive_model, command.left, command.right, command.left_acceleration,
+                                   command.right_acceleration);
+    if (drive_encoders && drive_model.kp != 0) {
+        volts[0] += drive_model.kp * (command.left - side_velocity(l_motors));
+        volts[1] += drive_model.kp * (command.right - side_velocity(r_motors));
+    }
+
+    const float limit = slip_limit.load(std::memory_order_relaxed);
+    if (limit >= 0 && odometry && odometry->get_slip().slipping) {
+        const double max_volts = std::min<double>(limit, JOYSTICK_MAX) / JOYSTICK_MAX * MAX_MOTOR_VOLTS;
+        for (auto& side : volts) side = std::clamp(side, -max_volts, max_volts);
+    }
+    l_motors.move_voltage(to_motor_millivolts(drive_model, volts[0], battery_volts));
+    r_motors.move_voltage(to_motor_millivolts(drive_model, volts[1], battery_volts));
+}
+
+// Median motor speed on one side in inches per second; 0 if no motor reads.
+double Chassis::side_velocity(const pros::MotorGroup& motors) const {
+    std::array<double, DriveEncoders::max_motors> rpm;
+    const std::size_t count = std::min<std::size_t>(motors.size(), rpm.size());
+    for (std::size_t i = 0; i < count; i++) rpm[i] = motors.get_actual_velocity(i);
+    const double median = DriveEncoders::median(rpm, count);
+    return std::isfinite(median) ? drive_encoders->degrees_to_distance(median * 6.0) : 0.0;
+}
+
+void Chassis::set_drive_model(const DriveModel& model) {
+    if (control_task) return;
+    drive_model = model;
+}
+
+void Chassis::drive_velocity(float left, float right, float left_acceleration, float right_acceleration) {
+    send_drive({DriveMode::Velocity, left, right, left_acceleration, right_acceleration});
+}
+
+void Chassis::start_control(uint32_t period_ms) {
+    if (control_task) return;
+    control_period_ms = std::clamp<uint32_t>(period_ms, 5, 20);
+    control_task.emplace([this] { control_loop(); }, TASK_PRIORITY_MAX - 3,
+                         TASK_STACK_DEPTH_DEFAULT, "Chassis Control");
+}
+
+void Chassis::control_loop() {
+    LoopStats stats = {};
+    const uint32_t period_us = control_period_ms * 1000;
+    uint32_t last_start_us = pros::micros();
+    uint32_t wake_time = pros::millis();
+    DriveCommand command = {DriveMode::Power, 0.0f, 0.0f, 0.0f, 0.0f};
+
+    while (true) {
+        const uint32_t start_us = pros::micros();
+
+        bool commanded = false;
+        if (auto next = drive_command.take()) {
+            command = *next;
+            commanded = true;
+        }
+        // A new command ends every motion. A cancel without one stops the
+        // drive; otherwise the cleared motion's last output would keep
+        // being written.
+        if (motions.clear(motion_controller, commanded) && !commanded) {
+            command = {DriveMode::Power, 0.0f, 0.0f, 0.0f, 0.0f};
+        }
+        step_motion(command);
+        write_drive(command);
+
+        record_tick(stats, start_us, last_start_us, period_us);
+        control_stats.store(stats);
+
+        pros::Task::delay_until(&wake_time, control_period_ms);
+    }
+}
+
+// Runs the active motion, or the next queued one, and replaces `command`
+// with its output. When a motion ends the next starts in the same tick, so a
+// chained motion hands over without a stopped tick.
+void Chassis::step_motion(DriveCommand& command) {
+    const Pose current = pose.load();
+    const float dt = control_period_ms / 1000.0f;
+    while (motions.start_next(motion_controller)) {
+        float left, right;
+        const MotionStatus status = motion_controller.step(current, dt, left, right);
+        command = {DriveMode::Power, left, right, 0.0f, 0.0f};
+        motion_progress.store({motions.running_id(), motion_controller.get_travelled(),
+                               motion_controller.get_elapsed() * 1000.0f});
+        if (status == MotionStatus::Running) return;
+        motions.finish(status);
+    }
+}
+
+bool Chassis::queue_motion(const Motion& motion, bool async) {
+    if (!control_task) return false;
+    uint32_t id;
+    while (!(id = motions.push(motion))) pros::delay(control_period_ms);
+    if (async) return true;
+    while (!motions.ended(id)) pros::delay(control_period_ms);
+    return motions.last_status() == MotionStatus::Settled;
+}
+
+bool Chassis::turn_to_heading(float heading, TurnParams params, bool async) {
+    return queue_motion({MotionType::TurnToHeading, 0.0f, 0.0f, heading, params, {}}, async);
+}
+
+bool Chassis::turn_to_point(float x, float y, TurnParams params, bool async) {
+    return queue_motion({MotionType::TurnToPoint, x, y, 0.0f, params, {}}, async);
+}
+
+bool Chassis::move_to_point(float x, float y, MoveParams params, bool async) {
+    return queue_motion({MotionType::MoveToPoint, x, y, 0.0f, {}, params}, async);
+}
+
+bool Chassis::move_to_pose(float x, float y, float heading, MoveParams params, bool async) {
+    return queue_motion({MotionType::MoveToPose, x, y, heading, {}, params}, async);
+}
+
+bool Chassis::follow_path(const Path& path, MoveParams params, bool async) {
+    if (path.size() < 2 || !path.finished()) return false;
+    return queue_motion({MotionType::FollowPath, 0.0f, 0.0f, 0.0f, {}, params, &path}, async);
+}
+
+void Chassis::wait_until(float distance) {
+    wait_for_progress([distance](const MotionProgress& progress) { return progress.travelled >= distance; });
+}
+
+void Chassis::wait_until_elapsed(uint32_t time_ms) {
+    wait_for_progress([time_ms](const MotionProgress& progress) { return progress.elapsed_ms >= time_ms; });
+}
+
+void Chassis::wait_until_done() {
+    const uint32_t id = motions.last_id();
+    while (!motions.ended(id)) pros::delay(control_period_ms);
+}
+
+void Chassis::cancel_motions() {
+    if (!control_task) return;
+    motions.cancel();
+    wait_until_done();
+}
+
+bool Chassis::is_in_motion() const {
+    return !motions.ended(motions.last_id());
+}
+
+void Chassis::set_motion_gains(const MotionGains& gains) {
+    if (control_task) return;
+    motion_controller.set_gains(gains);
+}
+
+LoopStats Chassis::get_control_stats() const {
+    return control_stats.load();
+}
+
+void Chassis::start_odometry(Odometry* odometry, uint32_t period_ms) {
+    if (odometry_task || !odometry) return;
+    Chassis::odometry = odometry;
+    if (drive_encoders) odometry->set_drive_encoders(&drive_encoders.value());
+    odometry_period_ms = std::clamp<uint32_t>(period_ms, 5, 10);
+    odometry_task.emplace([this] { odometry_loop(); }, TASK_PRIORITY_MAX - 2,
+                          TASK_STACK_DEPTH_DEFAULT, "Odometry");
+}
+
+void Chassis::set_drive_encoders(DriveEncoderConfig config) {
+    if (odometry_task) return;
+    drive_encoders.emplace(&l_motors, &r_motors, config);
+}
+
+void Chassis::odometry_loop() {
+    // The first update primes the wheels and reads the IMUs, so the reset
+    // after it anchors the starting pose to the real starting heading.
+    const Pose start = pose.load();
+    Pose current = start;
+    odometry->update(current);
+    current = start;
+    odometry->reset(current);
+    pose.store(current);
+    OdometryStats stats = {};
+    const uint32_t period_us = odometry_period_ms * 1000;
+    uint32_t last_start_us = pros::micros();
+    uint32_t wake_time = pros::millis();
+
+    while (true) {
+        const uint32_t start_us = pros::micros();
+
+        bool reset = false;
+        while (auto next = pose_resets.pop()) {
+            current = *next;
+            reset = true;
+        }
+        if (reset) odometry->reset(current);
+
+        odometry->update(current);
+        pose.store(current);
+
+        if (imu_drift_learning.load(std::memory_order_relaxed) && pros::competition::is_disabled()) {
+            odometry->learn_imu_drift(motors_still());
+        }
+
+        record_tick(stats, start_us, last_start_us, period_us);
+        odometry_stats.store(stats);
+
+        pros::Task::delay_until(&wake_time, odometry_period_ms);
+    }
+}
+
+bool Chassis::motors_still() const {
+    for (const auto* motors : {&l_motors, &r_motors}) {
+        for (int8_t i = 0; i < motors->size(); i++) {
+            if (std::abs(motors->get_actual_velocity(i)) > STILL_MOTOR_RPM) return false;
+        }
+    }
+    return true;
+}
+
+void Chassis::set_imu_drift_learning(bool enabled) {
+    imu_drift_learning.store(enabled, std::memory_order_relaxed);
 }
 
 void Chassis::set_pose(float x, float y, float heading) {
-    Chassis::pose = {x, y, heading};
+    set_pose(Pose(x, y, heading));
 }
 
 void Chassis::set_pose(Pose pose) {
-    Chassis::pose = pose;
+    if (!odometry_task) {
+        Chassis::pose.store(pose);
+        return;
+    }
+    while (!pose_resets.push(pose)) pros::delay(odometry_period_ms);
+}
+
+Pose Chassis::get_pose() const {
+    return pose.load();
+}
+
+OdometryStats Chassis::get_odometry_stats() const {
+    return odometry_stats.load();
 }
@@ -0,0 +1,72 @@
+#include "drive_model.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <utility>
+
+static double sign(double value) {
+    return value > 0 ? 1.0 : value < 0 ? -1.0 : 0.0;
+}
+
+std::array<double, 2> drive_feedforward(const DriveModel& model, double left_velocity, double right_velocity,
+    double left_acceleration, double right_acceleration) {
+    const double linear_velocity = (left_velocity + right_velocity) / 2;
+    const double angular_velocity = (left_velocity - right_velocity) / 2;
+    const double linear_acceleration = (left_acceleration + right_acceleration) / 2;
+    const double angular_acceleration = (left_acceleration - right_acceleration) / 2;
+
+    // Static friction is weighted by how much of the motion is turning.
+    const double motion = std::abs(linear_velocity) + std::abs(angular_velocity);
+    const double ks = motion > 0
+        ? (std::abs(linear_velocity) * model.linear.ks + std::abs(angular_velocity) * model.angular.ks) / motion
+        : model.linear.ks;
+
+    const double linear = model.linear.kv * linear_velocity + model.linear.ka * linear_acceleration;
+    const double angular = model.angular.kv * angular_velocity + model.angular.ka * angular_acceleration;
+    return {ks * sign(left_velocity) + linear + angular, ks * sign(right_velocity) + linear - angular};
+}
+
+int32_t to_motor_millivolts(const DriveModel& model, double volts, double battery_volts) {
+    if (model.battery_compensation && battery_volts > 1.0) volts *= NOMINAL_BATTERY_VOLTS / battery_volts;
+    volts = std::clamp(volts, -MAX_MOTOR_VOLTS, MAX_MOTOR_VOLTS);
+    return static_cast<int32_t>(std::lround(volts * 1000.0));
+}
+
+bool save_drive_model(const char* path, const DriveModel& model) {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    bool ok = true;
+    for (const auto& [name, ff] : {std::pair{"linear", model.linear}, std::pair{"angular", model.angular}}) {
+        ok = ok && std::fprintf(file, "%s %.9g %.9g %.9g\n", name, ff.ks, ff.kv, ff.ka) > 0;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool load_drive_model(const char* path, DriveModel& model) {
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+
+    char name[16];
+    Feedforward ff;
+    DriveModel loaded = model;
+    bool linear = false, angular = false, ok = true;
+    int fields;
+    while ((fields = std::fscanf(file, " %15s %lf %lf %lf", name, &ff.ks, &ff.kv, &ff.ka)) == 4) {
+        if (!std::isfinite(ff.ks) || !std::isfinite(ff.kv) || !std::isfinite(ff.ka)) {
+            ok = false;
+        } else if (std::strcmp(name, "linear") == 0) {
+            loaded.linear = ff;
+            linear = true;
+        } else if (std::strcmp(name, "angular") == 0) {
+            loaded.angular = ff;
+            angular = true;
+        } else {
+            ok = false;
+        }
+    }
+    std::fclose(file);
+    if (!ok || fields != EOF || !linear || !angular) return false;
+    model = loaded;
+    return true;
+}
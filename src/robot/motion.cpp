@@ -0,0 +1,234 @@
+#include "motion.h"
+#include "utils/angle.h"
+#include "utils/trig.h"
+#include <algorithm>
+#include <cmath>
+
+static PidConfig<float> pid_config(float max_speed, const ExitCondition& exit) {
+    PidConfig<float> config;
+    config.output_limit = max_speed;
+    config.integral_limit = max_speed;
+    config.settle_error = exit.error;
+    config.settle_rate = exit.rate;
+    config.settle_time = exit.time_ms / 1000.0f;
+    return config;
+}
+
+static bool is_turn(MotionType type) {
+    return type == MotionType::TurnToHeading || type == MotionType::TurnToPoint;
+}
+
+// Heading that points the drive direction at (x, y).
+static float bearing(Pose pose, float x, float y, bool forwards) {
+    const float heading = static_cast<float>(Trig::atan2(y - pose.y, x - pose.x));
+    return forwards ? heading : heading + static_cast<float>(M_PI);
+}
+
+MotionController::MotionController(MotionGains gains)
+    : gains(gains),
+    linear(gains.linear),
+    angular(gains.angular) {}
+
+void MotionController::set_gains(const MotionGains& gains) {
+    this->gains = gains;
+}
+
+void MotionController::start(const Motion& motion) {
+    this->motion = motion;
+    running = true;
+    elapsed = 0.0f;
+    travelled = 0.0f;
+    primed = false;
+    close = false;
+    pursuit.reset();
+    const float max_speed = is_turn(motion.type) ? motion.turn.max_speed : motion.move.max_speed;
+    linear = Pid<float, linear_options>(gains.linear, pid_config(motion.move.max_speed, motion.move.exit));
+    angular = Pid<float, angular_options>(gains.angular, pid_config(max_speed, motion.turn.exit));
+}
+
+MotionStatus MotionController::step(Pose pose, float dt, float& left, float& right) {
+    left = 0.0f;
+    right = 0.0f;
+    if (!running) return MotionStatus::Idle;
+
+    const bool turn = is_turn(motion.type);
+    float moved = 0.0f;
+    if (primed) {
+        moved = turn ? std::abs(static_cast<float>(wrap_angle(pose.heading - last_heading)))
+                     : std::hypot(pose.x - last_x, pose.y - last_y);
+        travelled += moved;
+    }
+    primed = true;
+    last_x = pose.x;
+    last_y = pose.y;
+    last_heading = pose.heading;
+    elapsed += dt;
+    if (elapsed * 1000.0f >= (turn ? motion.turn.timeout_ms : motion.move.timeout_ms)) {
+        running = false;
+        return MotionStatus::TimedOut;
+    }
+
+    if (turn) {
+        const float target = motion.type == MotionType::TurnToHeading ? motion.heading : bearing(pose, motion.x, motion.y, true);
+        float output = angular.update(target, pose.heading, dt);
+        const float min_speed = motion.turn.min_speed;
+        const bool done = min_speed > 0.0f ? std::abs(angular.get_error()) < motion.turn.exit.error : angular.settled();
+        if (done) {
+            running = false;
+            return MotionStatus::Settled;
+        }
+        if (std::abs(output) < min_speed) output = std::copysign(min_speed, output);
+        left = output;
+        right = -output;
+        return MotionStatus::Running;
+    }
+
+    if (motion.type == MotionType::FollowPath) return follow_path(pose, dt > 0.0f ? moved / dt : 0.0f, left, right);
+
+    const bool forwards = motion.move.forwards;
+    const float distance = std::hypot(motion.x - pose.x, motion.y - pose.y);
+    if (distance < gains.close_distance) close = true;
+
+    // Distance still to go along the drive direction; negative once passed.
+    const float along = distance * static_cast<float>(Trig::cos(wrap_angle(bearing(pose, motion.x, motion.y, forwards) - pose.heading)));
+    float linear_output = linear.update(0.0f, -along, dt);
+    if (!forwards) linear_output = -linear_output;
+
+    // Boomerang: steer at a carrot behind the target along its heading, which
+    // pulls in towards the target as the distance closes.
+    float angular_output = 0.0f;
+    if (motion.type == MotionType::MoveToPose) {
+        float target = motion.heading;
+        if (!close) {
+            const float lead = (forwards ? 1.0f : -1.0f) * motion.move.lead * distance;
+            double s, c;
+            Trig::sincos(motion.heading, s, c);
+            target = bearing(pose, motion.x - lead * static_cast<float>(c), motion.y - lead * static_cast<float>(s), forwards);
+        }
+        angular_output = angular.update(target, pose.heading, dt);
+    } else if (!close) {
+        angular_output = angular.update(bearing(pose, motion.x, motion.y, forwards), pose.heading, dt);
+    }
+
+    const float min_speed = motion.move.min_speed;
+    const bool heading_done = motion.type != MotionType::MoveToPose || (close && (min_speed > 0.0f || angular.settled()));
+    const bool position_done = min_speed > 0.0f ? along < motion.move.exit.error : linear.settled();
+    if (position_done && heading_done) {
+        running = false;
+        return MotionStatus::Settled;
+    }
+    if (std::abs(linear_output) < min_speed) linear_output = std::copysign(min_speed, forwards ? along : -along);
+
+    // Turning keeps priority when both together would exceed the cap.
+    const float max_speed = motion.move.max_speed;
+    if (std::abs(linear_output) + std::abs(angular_output) > max_speed) {
+        linear_output = std::copysign(std::max(max_speed - std::abs(angular_output), 0.0f), linear_output);
+    }
+    left = linear_output + angular_output;
+    right = linear_output - angular_output;
+    return MotionStatus::Running;
+}
+
+MotionStatus MotionController::follow_path(Pose pose, float speed, float& left, float& right) {
+    const bool forwards = motion.move.forwards;
+    const float heading = forwards ? pose.heading : pose.heading + static_cast<float>(M_PI);
+    const PursuitTarget target = pursuit.step(*motion.path, pose, heading, speed, gains.pursuit);
+
+    const float min_speed = motion.move.min_speed;
+    const float exit_error = motion.move.exit.error;
+    if (target.at_end && (min_speed > 0.0f ? target.end_along < exit_error : target.remaining < exit_error)) {
+        running = false;
+        return MotionStatus::Settled;
+    }
+
+    // Slow for tight path sections and into the end of the path.
+    const float max_speed = motion.move.max_speed;
+    float drive = max_speed / (1 + gains.pursuit.curvature_slowdown * std::abs(target.path_curvature));
+    if (min_speed <= 0.0f) drive = std::min(drive, gains.linear.kp * target.remaining);
+    drive = std::max(drive, min_speed);
+
+    const float half_turn = target.curvature * gains.pursuit.track_width / 2;
+    float outer = drive * (1 + half_turn), inner = drive * (1 - half_turn);
+    const float largest = std::max(std::abs(outer), std::abs(inner));
+    if (largest > max_speed) {
+        outer *= max_speed / largest;
+        inner *= max_speed / largest;
+    }
+    // Backwards, the drive direction's left side is the robot's right.
+    left = forwards ? outer : -inner;
+    right = forwards ? inner : -outer;
+    return MotionStatus::Running;
+}
+
+void MotionController::cancel() {
+    running = false;
+}
+
+bool MotionController::active() const {
+    return running;
+}
+
+float MotionController::get_travelled() const {
+    return travelled;
+}
+
+float MotionController::get_elapsed() const {
+    return elapsed;
+}
+
+uint32_t MotionQueue::push(const Motion& motion) {
+    if (!requests.push(motion)) return 0;
+    return ++requested;
+}
+
+void MotionQueue::cancel() {
+    cancelled.store(requested, std::memory_order_release);
+}
+
+uint32_t MotionQueue::last_id() const {
+    return requested;
+}
+
+bool MotionQueue::ended(uint32_t id) const {
+    return finished.load(std::memory_order_acquire) >= id;
+}
+
+MotionStatus MotionQueue::last_status() const {
+    return final_status.load(std::memory_order_relaxed);
+}
+
+bool MotionQueue::start_next(MotionController& controller) {
+    if (controller.active()) return true;
+    auto next = requests.pop();
+    if (!next) return false;
+    controller.start(*next);
+    started++;
+    return true;
+}
+
+uint32_t MotionQueue::running_id() const {
+    return started;
+}
+
+void MotionQueue::finish(MotionStatus status) {
+    final_status.store(status, std::memory_order_relaxed);
+    finished.fetch_add(1, std::memory_order_release);
+}
+
+bool MotionQueue::clear(MotionController& controller, bool all) {
+    // Motions are pushed before their id is handed out, so every id up to
+    // the cancelled one is already in the queue.
+    const uint32_t through = all ? UINT32_MAX : cancelled.load(std::memory_order_acquire);
+    bool cleared = false;
+    if (controller.active() && started <= through) {
+        controller.cancel();
+        finish(MotionStatus::Cancelled);
+        cleared = true;
+    }
+    while (started < through && requests.pop()) {
+        started++;
+        finish(MotionStatus::Cancelled);
+        cleared = true;
+    }
+    return cleared;
+}
@@ -0,0 +1,78 @@
+#include "path.h"
+#include <cmath>
+#include <cstdio>
+
+static constexpr float MIN_SPACING = 1e-3f;
+// Curvature is taken over points this far apart along the path, so float
+// rounding between dense points does not turn into curvature noise.
+static constexpr float CURVATURE_SPAN = 3.0f;
+
+void Path::reserve(std::size_t points) {
+    x.reserve(points);
+    y.reserve(points);
+    distance.reserve(points);
+    curvature.reserve(points);
+}
+
+void Path::add_point(float px, float py) {
+    float travelled = 0.0f;
+    if (!x.empty()) {
+        const float step = std::hypot(px - x.back(), py - y.back());
+        if (step < MIN_SPACING) return;
+        travelled = distance.back() + step;
+    }
+    x.push_back(px);
+    y.push_back(py);
+    distance.push_back(travelled);
+}
+
+void Path::finish() {
+    const std::size_t n = x.size();
+    curvature.assign(n, 0.0f);
+    std::size_t before = 0, after = 0;
+    for (std::size_t i = 0; i < n; i++) {
+        while (before < i && distance[i] - distance[before + 1] >= CURVATURE_SPAN) before++;
+        if (after < i) after = i;
+        while (after + 1 < n && distance[after] - distance[i] < CURVATURE_SPAN) after++;
+        if (before == i || after == i) continue;
+
+        // Menger curvature of (before, i, after): 4 * area / product of sides.
+        const float ax = x[i] - x[before], ay = y[i] - y[before];
+        const float bx = x[after] - x[i], by = y[after] - y[i];
+        const float cross = ax * by - ay * bx;
+        const float sides = std::hypot(ax, ay) * std::hypot(bx, by) * std::hypot(x[after] - x[before], y[after] - y[before]);
+        if (sides > 0) curvature[i] = 2 * cross / sides;
+    }
+}
+
+void Path::clear() {
+    x.clear();
+    y.clear();
+    distance.clear();
+    curvature.clear();
+}
+
+bool Path::finished() const {
+    return curvature.size() == x.size();
+}
+
+std::size_t Path::size() const {
+    return x.size();
+}
+
+bool load_path(const char* file, Path& path) {
+    std::FILE* input = std::fopen(file, "r");
+    if (!input) return false;
+
+    path.clear();
+    char line[128];
+    while (std::fgets(line, sizeof(line), input)) {
+        float px, py;
+        if (std::sscanf(line, " %f , %f", &px, &py) == 2 || std::sscanf(line, " %f %f", &px, &py) == 2) {
+            path.add_point(px, py);
+        }
+    }
+    std::fclose(input);
+    path.finish();
+    return path.size() >= 2;
+}
@@ -0,0 +1,83 @@
+#include "pure_pursuit.h"
+#include "utils/trig.h"
+#include <algorithm>
+#include <cmath>
+
+void PurePursuit::reset() {
+    closest = 0;
+    lookahead = 0;
+}
+
+PursuitTarget PurePursuit::step(const Path& path, Pose pose, float heading, float speed, const PursuitConfig& config) {
+    const std::size_t n = path.size();
+    if (n == 0 || !path.finished()) return {0.0f, 0.0f, 0.0f, 0.0f, true};
+    const auto distance_squared = [&](std::size_t i) {
+        const float dx = path.x[i] - pose.x, dy = path.y[i] - pose.y;
+        return dx * dx + dy * dy;
+    };
+
+    // Closest point: forwards from the last one, no further than the robot
+    // could be reaching anyway.
+    const std::size_t closest_end = std::min(closest + config.max_search_points, n);
+    float best = distance_squared(closest);
+    for (std::size_t i = closest + 1; i < closest_end && path.distance[i] - path.distance[closest] <= config.max_lookahead; i++) {
+        const float d = distance_squared(i);
+        if (d < best) {
+            best = d;
+            closest = i;
+        }
+    }
+    const float path_curvature = path.curvature[closest];
+
+    float radius = std::clamp(config.min_lookahead + config.speed_lookahead * std::abs(speed), config.min_lookahead, config.max_lookahead);
+    radius = std::max(radius / (1 + config.curvature_lookahead * std::abs(path_curvature)), config.min_lookahead);
+    const float radius_squared = radius * radius;
+
+    // Lookahead point: the first place past the last one where the path
+    // leaves the circle, interpolated along that segment.
+    std::size_t i = std::max(lookahead, closest);
+    const std::size_t lookahead_end = std::min(i + config.max_search_points, n - 1);
+    float target_x = path.x[n - 1], target_y = path.y[n - 1];
+    bool at_end = true;
+    if (distance_squared(i) >= radius_squared) {
+        target_x = path.x[i];
+        target_y = path.y[i];
+        at_end = i == n - 1;
+    } else {
+        for (; i < lookahead_end; i++) {
+            if (distance_squared(i + 1) < radius_squared) continue;
+            const float sx = path.x[i + 1] - path.x[i], sy = path.y[i + 1] - path.y[i];
+            const float fx = path.x[i] - pose.x, fy = path.y[i] - pose.y;
+            const float a = sx * sx + sy * sy;
+            const float b = 2 * (fx * sx + fy * sy);
+            const float c = fx * fx + fy * fy - radius_squared;
+            const float t = (-b + std::sqrt(std::max(b * b - 4 * a * c, 0.0f))) / (2 * a);
+            target_x = path.x[i] + std::clamp(t, 0.0f, 1.0f) * sx;
+            target_y = path.y[i] + std::clamp(t, 0.0f, 1.0f) * sy;
+            at_end = false;
+            break;
+        }
+        if (at_end && lookahead_end < n - 1) {
+            target_x = path.x[lookahead_end];
+            target_y = path.y[lookahead_end];
+            at_end = false;
+        }
+    }
+    lookahead = i;
+
+    double sin_heading, cos_heading;
+    Trig::sincos(heading, sin_heading, cos_heading);
+    const float s = static_cast<float>(sin_heading), c = static_cast<float>(cos_heading);
+    const float dx = target_x - pose.x, dy = target_y - pose.y;
+    const float lateral = -s * dx + c * dy;
+    const float chord_squared = dx * dx + dy * dy;
+    const float curvature = chord_squared > 1e-6f ? 2 * lateral / chord_squared : 0.0f;
+
+    const float end_x = path.x[n - 1] - pose.x, end_y = path.y[n - 1] - pose.y;
+    const float remaining = at_end ? std::hypot(end_x, end_y) : path.distance[n - 1] - path.distance[closest];
+    return {curvature, path_curvature, remaining, c * end_x + s * end_y, at_end};
+}
+
+std::size_t PurePursuit::get_closest() const {
+    return closest;
+}
@@ -0,0 +1,80 @@
+// Chassis::run_sysid(), kept apart from the control code in chassis.cpp.
+#include "chassis.h"
+#include "pros/error.h"
+#include "pros/misc.hpp"
+#include "pros/rtos.hpp"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static constexpr uint32_t SAMPLE_PERIOD_MS = 10;
+
+static bool write_sysid_csv(const char* path, const std::vector<SysidSample>& samples) {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    bool ok = std::fputs("test,direction,time_ms,left_volts,right_volts,left_velocity,right_velocity,"
+                         "left_acceleration,right_acceleration,battery_volts\n", file) != EOF;
+    for (const auto& sample : samples) {
+        ok = ok && std::fprintf(file, "%s,%d,%lu,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f\n",
+                                sysid_test_name(sample.test), sample.direction, static_cast<unsigned long>(sample.time_ms),
+                                sample.left_volts, sample.right_volts, sample.left_velocity, sample.right_velocity,
+                                sample.left_acceleration, sample.right_acceleration, sample.battery_volts) > 0;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool Chassis::run_sysid(const char* path, SysidConfig config) {
+    if (!drive_encoders) return false;
+
+    static constexpr SysidTest TESTS[] = {SysidTest::QuasistaticLinear, SysidTest::QuasistaticAngular,
+                                          SysidTest::DynamicLinear, SysidTest::DynamicAngular};
+    const std::size_t capacity = 2 * (2 * config.quasistatic_ms + 2 * config.dynamic_ms) / SAMPLE_PERIOD_MS + 16;
+    std::vector<SysidSample> samples;
+    samples.reserve(capacity);
+
+    for (SysidTest test : TESTS) {
+        const bool quasistatic = test == SysidTest::QuasistaticLinear || test == SysidTest::QuasistaticAngular;
+        const bool angular = test == SysidTest::QuasistaticAngular || test == SysidTest::DynamicAngular;
+        const uint32_t duration_ms = quasistatic ? config.quasistatic_ms : config.dynamic_ms;
+
+        for (int8_t direction : {1, -1}) {
+            const uint32_t start_ms = pros::millis();
+            uint32_t wake_time = start_ms;
+            uint32_t last_ms = start_ms;
+            float volts = 0.0f;
+            double last_left = 0, last_right = 0;
+
+            while (samples.size() < capacity) {
+                const uint32_t now = pros::millis();
+                const uint32_t elapsed_ms = now - start_ms;
+                if (elapsed_ms >= duration_ms) break;
+
+                // Log what the last command produced, then issue the next.
+                const double left = side_velocity(l_motors);
+                const double right = side_velocity(r_motors);
+                const double dt = (now - last_ms) / 1000.0;
+                const int32_t battery_mv = pros::battery::get_voltage();
+                if (now != start_ms) {
+                    samples.push_back({test, direction, elapsed_ms, volts, angular ? -volts : volts,
+                                       static_cast<float>(left), static_cast<float>(right),
+                                       static_cast<float>(dt > 0 ? (left - last_left) / dt : 0),
+                                       static_cast<float>(dt > 0 ? (right - last_right) / dt : 0),
+                                       battery_mv == PROS_ERR ? NAN : battery_mv / 1000.0f});
+                }
+                last_left = left;
+                last_right = right;
+                last_ms = now;
+
+                volts = direction * static_cast<float>(quasistatic ? config.ramp_rate * elapsed_ms / 1000.0 : config.step_volts);
+                send_drive({DriveMode::Voltage, volts, angular ? -volts : volts, 0.0f, 0.0f});
+                pros::Task::delay_until(&wake_time, SAMPLE_PERIOD_MS);
+            }
+
+            send_drive({DriveMode::Voltage, 0.0f, 0.0f, 0.0f, 0.0f});
+            pros::delay(config.rest_ms);
+        }
+    }
+
+    send_drive({DriveMode::Power, 0.0f, 0.0f, 0.0f, 0.0f});
+    return write_sysid_csv(path, samples);
+}
@@ -0,0 +1,80 @@
+#include "drive_encoders.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr double DEGREES_PER_REVOLUTION = 360.0;
+
+DriveEncoders::DriveEncoders(pros::MotorGroup* left_motors, pros::MotorGroup* right_motors, DriveEncoderConfig config)
+    : left_motors(left_motors),
+    right_motors(right_motors),
+    config(config) {}
+
+void DriveEncoders::set_positions(double left, double right) {
+    if (!primed) {
+        resync(left, right);
+        return;
+    }
+    step_left = left - last_left;
+    step_right = right - last_right;
+    total_left += step_left;
+    total_right += step_right;
+    last_left = left;
+    last_right = right;
+}
+
+void DriveEncoders::resync(double left, double right) {
+    primed = true;
+    step_left = 0;
+    step_right = 0;
+    last_left = left;
+    last_right = right;
+}
+
+double DriveEncoders::peek_travel(double left, double right) const {
+    if (!primed) return 0;
+    return std::max(std::abs(degrees_to_distance(left - last_left)), std::abs(degrees_to_distance(right - last_right)));
+}
+
+double DriveEncoders::degrees_to_distance(double degrees) const {
+    return degrees / DEGREES_PER_REVOLUTION * config.gear_ratio * M_PI * config.wheel_diameter;
+}
+
+double DriveEncoders::get_distance_delta() {
+    const double centre = (total_left + total_right) / 2;
+    const double delta = centre - last_centre;
+    last_centre = centre;
+    return degrees_to_distance(delta);
+}
+
+std::array<double, 2> DriveEncoders::get_side_deltas() const {
+    return {degrees_to_distance(step_left), degrees_to_distance(step_right)};
+}
+
+double DriveEncoders::get_heading_total() const {
+    return degrees_to_distance(total_left - total_right) / config.track_width;
+}
+
+DriveEncoderConfig DriveEncoders::get_config() const {
+    return config;
+}
+
+pros::MotorGroup* DriveEncoders::get_left_motors() {
+    return left_motors;
+}
+
+pros::MotorGroup* DriveEncoders::get_right_motors() {
+    return right_motors;
+}
+
+double DriveEncoders::median(std::array<double, max_motors>& positions, std::size_t count) {
+    auto end = std::remove_if(positions.begin(), positions.begin() + std::min(count, max_motors),
+                              [](double position) { return !std::isfinite(position); });
+    const std::size_t used = end - positions.begin();
+    if (used == 0) return NAN;
+
+    auto middle = positions.begin() + used / 2;
+    std::nth_element(positions.begin(), middle, end);
+    if (used % 2) return *middle;
+    const double below = *std::max_element(positions.begin(), middle);
+    return (below + *middle) / 2;
+}
@@ -0,0 +1,60 @@
+#include "field_map.h"
+#include <algorithm>
+#include <cmath>
+
+static constexpr int MAX_STEPS = 128;
+// Nearest-cell lookups can overstate clearance by up to half a cell diagonal.
+static constexpr float CELL_MARGIN = 0.71f * FieldMap::resolution;
+
+static float segment_distance(const Segment& segment, float x, float y) {
+    float dx = segment.x2 - segment.x1;
+    float dy = segment.y2 - segment.y1;
+    float length_squared = dx * dx + dy * dy;
+    float t = length_squared > 0 ? ((x - segment.x1) * dx + (y - segment.y1) * dy) / length_squared : 0;
+    t = std::clamp(t, 0.0f, 1.0f);
+    return std::hypot(x - (segment.x1 + t * dx), y - (segment.y1 + t * dy));
+}
+
+FieldMap::FieldMap() {
+    add_segment({-half_size, -half_size, half_size, -half_size});
+    add_segment({half_size, -half_size, half_size, half_size});
+    add_segment({half_size, half_size, -half_size, half_size});
+    add_segment({-half_size, half_size, -half_size, -half_size});
+}
+
+bool FieldMap::add_segment(const Segment& segment) {
+    if (segment_count == max_segments) return false;
+    segments[segment_count++] = segment;
+    return true;
+}
+
+void FieldMap::build() {
+    for (std::size_t row = 0; row < cells; row++) {
+        for (std::size_t col = 0; col < cells; col++) {
+            float x = -half_size + col * resolution;
+            float y = -half_size + row * resolution;
+            float nearest = 2 * half_size;
+            for (std::size_t i = 0; i < segment_count; i++) {
+                nearest = std::min(nearest, segment_distance(segments[i], x, y));
+            }
+            field[row * cells + col] = nearest;
+        }
+    }
+}
+
+float FieldMap::distance(float x, float y) const {
+    int col = static_cast<int>((x + half_size) / resolution + 0.5f);
+    int row = static_cast<int>((y + half_size) / resolution + 0.5f);
+    if (col < 0 || row < 0 || col >= static_cast<int>(cells) || row >= static_cast<int>(cells)) return 0;
+    return field[row * cells + col];
+}
+
+float FieldMap::raycast(float x, float y, float dx, float dy, float max_range) const {
+    float travelled = 0;
+    for (int step = 0; step < MAX_STEPS && travelled < max_range; step++) {
+        float clearance = distance(x + dx * travelled, y + dy * travelled);
+        if (clearance < CELL_MARGIN) return travelled;
+        travelled += std::max(clearance - CELL_MARGIN, resolution * 0.5f);
+    }
+    return max_range;
+}
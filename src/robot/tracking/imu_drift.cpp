@@ -0,0 +1,32 @@
+#include "imu_drift.h"
+#include <algorithm>
+
+void ImuDriftEstimator::sample(std::size_t index, double rotation, uint64_t timestamp_us) {
+    Window& window = windows[index];
+    if (!window.open) {
+        window = {true, timestamp_us, rotation};
+        return;
+    }
+
+    double elapsed_s = (timestamp_us - window.start_us) / 1e6;
+    if (elapsed_s < window_s) return;
+
+    ImuDrift& drift = drifts[index];
+    double total_s = drift.learned_s + elapsed_s;
+    drift.rate = (drift.rate * drift.learned_s + (rotation - window.start_rotation)) / total_s;
+    drift.learned_s = std::min(total_s, memory_s);
+
+    window = {true, timestamp_us, rotation};
+}
+
+void ImuDriftEstimator::interrupt() {
+    for (auto& window : windows) window.open = false;
+}
+
+const ImuDrift& ImuDriftEstimator::get(std::size_t index) const {
+    return drifts[index];
+}
+
+void ImuDriftEstimator::set(std::size_t index, const ImuDrift& drift) {
+    drifts[index] = drift;
+}
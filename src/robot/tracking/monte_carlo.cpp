@@ -0,0 +1,197 @@
+#include "monte_carlo.h"
+#include "utils/angle.h"
+#include "utils/trig.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+static constexpr int32_t NO_OBJECT_MM = 9999;
+static constexpr int32_t MAX_CONFIDENCE = 63;
+// Errors beyond this many sigma are treated as unmodelled obstacles rather
+// than evidence against the particle.
+static constexpr float OUTLIER_SIGMA = 3.0f;
+
+struct Reading {
+    float range;
+    float inverse_variance;
+    float cos_angle;
+    float sin_angle;
+};
+
+MonteCarloLocalizer::MonteCarloLocalizer(Odometry* odometry, const FieldMap* map,
+    std::vector<DistanceSensorConfig> sensors, MonteCarloConfig config)
+    : odometry(odometry),
+      map(map),
+      sensor_count(std::min(sensors.size(), max_sensors)),
+      config(config) {
+    std::copy_n(sensors.begin(), sensor_count, MonteCarloLocalizer::sensors.begin());
+    MonteCarloLocalizer::config.particle_count = std::clamp<std::size_t>(config.particle_count, 1, max_particles);
+}
+
+float MonteCarloLocalizer::uniform() {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return (rng_state >> 8) * (1.0f / 16777216.0f);
+}
+
+float MonteCarloLocalizer::gaussian() {
+    // Irwin-Hall approximation; cheap and bounded.
+    return (uniform() + uniform() + uniform() + uniform() - 2.0f) * 1.7320508f;
+}
+
+void MonteCarloLocalizer::initialize(const Pose& pose, float spread_xy, float spread_heading) {
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        particles.x[i] = pose.x + spread_xy * gaussian();
+        particles.y[i] = pose.y + spread_xy * gaussian();
+        particles.heading[i] = wrap_angle(pose.heading + spread_heading * gaussian());
+        weights[i] = 1.0f / config.particle_count;
+    }
+    estimate_pose = pose;
+    last_dead_reckoned.reset();
+    last_submit_us.reset();
+}
+
+void MonteCarloLocalizer::predict(const Pose& dead_reckoned) {
+    if (!last_dead_reckoned) {
+        last_dead_reckoned = dead_reckoned;
+        return;
+    }
+
+    // Robot-frame motion since the last cycle.
+    float dx = dead_reckoned.x - last_dead_reckoned->x;
+    float dy = dead_reckoned.y - last_dead_reckoned->y;
+    double s, c;
+    Trig::sincos(last_dead_reckoned->heading, s, c);
+    float local_x = c * dx + s * dy;
+    float local_y = -s * dx + c * dy;
+    float d_heading = wrap_angle(dead_reckoned.heading - last_dead_reckoned->heading);
+    last_dead_reckoned = dead_reckoned;
+
+    float translation_sigma = config.translation_noise * std::hypot(local_x, local_y);
+    float rotation_sigma = config.rotation_noise * std::abs(d_heading);
+
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        float px = local_x + translation_sigma * gaussian();
+        float py = local_y + translation_sigma * gaussian();
+        float heading = particles.heading[i];
+        double ps, pc;
+        Trig::sincos(heading, ps, pc);
+        particles.x[i] += pc * px - ps * py;
+        particles.y[i] += ps * px + pc * py;
+        particles.heading[i] = wrap_angle(heading + d_heading + rotation_sigma * gaussian());
+    }
+}
+
+bool MonteCarloLocalizer::weigh(const Ranges& ranges) {
+    std::array<Reading, max_sensors> readings;
+    std::array<std::size_t, max_sensors> sensor_index;
+    std::size_t reading_count = 0;
+
+    for (std::size_t i = 0; i < sensor_count; i++) {
+        int32_t distance = ranges[i].distance_mm;
+        int32_t confidence = ranges[i].confidence;
+        if (distance <= 0 || distance >= NO_OBJECT_MM || confidence <= 0 || confidence > MAX_CONFIDENCE) continue;
+
+        float range = distance * config.units_per_mm;
+        if (range >= config.max_range) continue;
+
+        float sigma = config.sensor_sigma * MAX_CONFIDENCE / confidence;
+        double s, c;
+        Trig::sincos(sensors[i].angle, s, c);
+        readings[reading_count] = {range, 1.0f / (sigma * sigma), static_cast<float>(c), static_cast<float>(s)};
+        sensor_index[reading_count++] = i;
+    }
+    if (reading_count == 0) return false;
+
+    float max_log_weight = -INFINITY;
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        double sd, cd;
+        Trig::sincos(particles.heading[i], sd, cd);
+        float s = sd, c = cd;
+        float log_weight = 0;
+        for (std::size_t j = 0; j < reading_count; j++) {
+            const DistanceSensorConfig& mount = sensors[sensor_index[j]];
+            const Reading& reading = readings[j];
+            float origin_x = particles.x[i] + c * mount.x - s * mount.y;
+            float origin_y = particles.y[i] + s * mount.x + c * mount.y;
+            float ray_x = c * reading.cos_angle - s * reading.sin_angle;
+            float ray_y = s * reading.cos_angle + c * reading.sin_angle;
+            float expected = map->raycast(origin_x, origin_y, ray_x, ray_y, config.max_range);
+            float error_squared = (reading.range - expected) * (reading.range - expected) * reading.inverse_variance;
+            log_weight -= 0.5f * std::min(error_squared, OUTLIER_SIGMA * OUTLIER_SIGMA);
+        }
+        // Posterior: this reading's likelihood times the weight so far.
+        log_weight += std::log(std::max(weights[i], std::numeric_limits<float>::min()));
+        weights[i] = log_weight;
+        max_log_weight = std::max(max_log_weight, log_weight);
+    }
+
+    float total = 0;
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        weights[i] = std::exp(weights[i] - max_log_weight);
+        total += weights[i];
+    }
+    for (std::size_t i = 0; i < config.particle_count; i++) weights[i] /= total;
+    return true;
+}
+
+void MonteCarloLocalizer::resample() {
+    const std::size_t count = config.particle_count;
+    float sum_squared = 0;
+    for (std::size_t i = 0; i < count; i++) sum_squared += weights[i] * weights[i];
+    if (1.0f / sum_squared > 0.5f * count) return;
+
+    // Low-variance (systematic) resampling.
+    float step = 1.0f / count;
+    float target = uniform() * step;
+    float cumulative = weights[0];
+    std::size_t source = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        while (target > cumulative && source + 1 < count) cumulative += weights[++source];
+        scratch.x[i] = particles.x[source];
+        scratch.y[i] = particles.y[source];
+        scratch.heading[i] = particles.heading[source];
+        target += step;
+    }
+    std::swap(particles, scratch);
+    std::fill_n(weights.begin(), count, step);
+}
+
+void MonteCarloLocalizer::estimate(uint64_t timestamp_us) {
+    float mean_x = 0, mean_y = 0, sum_sin = 0, sum_cos = 0;
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        mean_x += weights[i] * particles.x[i];
+        mean_y += weights[i] * particles.y[i];
+        double s, c;
+        Trig::sincos(particles.heading[i], s, c);
+        sum_sin += weights[i] * s;
+        sum_cos += weights[i] * c;
+    }
+    float mean_heading = Trig::atan2(sum_sin, sum_cos);
+
+    float variance_xy = 0, variance_heading = 0;
+    for (std::size_t i = 0; i < config.particle_count; i++) {
+        float dx = particles.x[i] - mean_x, dy = particles.y[i] - mean_y;
+        float dh = wrap_angle(particles.heading[i] - mean_heading);
+        variance_xy += weights[i] * 0.5f * (dx * dx + dy * dy);
+        variance_heading += weights[i] * dh * dh;
+    }
+    estimate_pose = Pose(mean_x, mean_y, mean_heading);
+
+    if (std::sqrt(variance_xy) > config.converged_spread) return;
+    if (last_submit_us && timestamp_us - *last_submit_us < config.submit_period_ms * 1000ull) return;
+    last_submit_us = timestamp_us;
+    odometry->submit_measurement({timestamp_us, mean_x, mean_y, mean_heading, variance_xy, variance_heading, 11.34});
+}
+
+void MonteCarloLocalizer::update(uint64_t timestamp_us, const Ranges& ranges) {
+    predict(odometry->get_dead_reckoned_pose());
+    if (!weigh(ranges)) return;
+    estimate(timestamp_us);
+    resample();
+}
+
+Pose MonteCarloLocalizer::get_estimate() const {
+    return estimate_pose;
+}
@@ -0,0 +1,25 @@
+// MonteCarloLocalizer members that talk to V5 devices. Kept apart from
+// monte_carlo.cpp so the filter itself builds on the host for benchmarking.
+#include "monte_carlo.h"
+#include "pros/distance.hpp"
+#include "pros/rtos.hpp"
+
+void MonteCarloLocalizer::update() {
+    const uint64_t timestamp_us = pros::micros();
+    Ranges ranges{};
+    for (std::size_t i = 0; i < sensor_count; i++) {
+        ranges[i] = {sensors[i].sensor->get_distance(), sensors[i].sensor->get_confidence()};
+    }
+    update(timestamp_us, ranges);
+}
+
+void MonteCarloLocalizer::start(uint32_t period_ms) {
+    if (task) return;
+    task.emplace([this, period_ms] {
+        uint32_t wake_time = pros::millis();
+        while (true) {
+            update();
+            pros::Task::delay_until(&wake_time, period_ms);
+        }
+    }, TASK_PRIORITY_DEFAULT, TASK_STACK_DEPTH_DEFAULT, "Monte Carlo");
+}
@@ -1,60 +1,221 @@
 #include "odometry.h"
-#include "pros/imu.hpp"
+#include "drive_encoders.h"
+#include "odometry_log.h"
+#include "odometry_recorder.h"
+#include "pose_integrator.h"
+#include "pros/error.h"
 #include "tracking_wheel.h"
 #include "utils/angle.h"
 #include "utils/pose.h"
+#include "utils/trig.h"
+#include <algorithm>
+#include <array>
 #include <cmath>
+#include <cstdio>
+#include <initializer_list>
 #include <optional>
 #include <vector>
 
-struct TrackingWheelData {
-    double distance;
-    double total;
-    double offset;
-};
+using LateralData = Odometry::LateralData;
+
+template <typename Sensors>
+static std::size_t copy_sensors(Sensors& dest, const std::vector<typename Sensors::value_type>& src) {
+    const std::size_t count = std::min(src.size(), dest.size());
+    std::copy_n(src.begin(), count, dest.begin());
+    return count;
+}
+
+// Ticks shorter than this are treated as this long when bounding wheel speed.
+static constexpr double MIN_HEALTH_DT = 0.01;
+
+// Wheel travel per tick below which disagreement is too small to normalize.
+static constexpr double MIN_ADAPTATION_TRAVEL = 1e-3;
+
+// Seconds a fresh reading taken at `sample_us` covers: since the sensor was
+// last read, or the tick's `dt` for the first read. A repeated read already
+// showed the sensor had not moved, so it counts. Updates `read_us`.
+static double sample_interval(uint64_t sample_us, uint64_t& read_us, double dt) {
+    const double interval = read_us && sample_us > read_us ? (sample_us - read_us) / 1e6 : dt;
+    read_us = sample_us;
+    return interval;
+}
+
+// Only fresh wheels that pass the health checks make it into `data`, so a
+// failed wheel drops out of every estimate that consumes it. A stale wheel's
+// motion is picked up by its next fresh reading, so the speed bound on each
+// delta uses the time since that wheel was last read. A wheel that was read
+// this tick but repeated itself has not moved, which the stuck check counts
+// against it while its peers move.
+static void get_lateral_data(const std::array<TrackingWheel*, Odometry::max_wheels>& sensors,
+    const std::array<int32_t, Odometry::max_wheels>& ticks, uint8_t stale, uint8_t repeat, uint64_t timestamp_us,
+    const std::array<uint64_t, Odometry::max_wheels>& sample_us, std::array<uint64_t, Odometry::max_wheels>& read_us,
+    std::size_t count, std::array<SensorStatus, Odometry::max_wheels>& status, const HealthConfig& config, double dt,
+    LateralData& data) {
+    std::array<bool, Odometry::max_wheels> usable{};
+    std::array<bool, Odometry::max_wheels> repeated{};
+    std::array<double, Odometry::max_wheels> distances{};
+    double peer_motion = 0;
+
+    for (std::size_t i = 0; i < count; i++) {
+        SensorStatus& wheel = status[i];
+        if (!wheel.healthy) continue;
+        if (stale >> i & 1) {
+            if (repeat >> i & 1) {
+                repeated[i] = true;
+                read_us[i] = timestamp_us;
+            }
+            continue;
+        }
+        if (ticks[i] == PROS_ERR) {
+            wheel.errors++;
+            wheel.healthy = false;
+            wheel.needs_resync = true;
+            continue;
+        }
+        const double limit = config.max_wheel_speed * std::max(sample_interval(sample_us[i], read_us[i], dt), MIN_HEALTH_DT);
+        if (wheel.needs_resync) {
+            sensors[i]->resync(ticks[i]);
+            wheel.needs_resync = false;
+        }
 
-static std::vector<TrackingWheelData> get_lateral_data(const std::vector<TrackingWheel*>& sensors) {
-    std::vector<TrackingWheelData> data;
-    for (auto* sensor : sensors) {
+        distances[i] = sensors[i]->ticks_to_distance(sensors[i]->peek_delta(ticks[i]));
+        if (std::abs(distances[i]) > limit) {
+            wheel.jumps++;
+            sensors[i]->resync(ticks[i]);
+            if (wheel.jumps >= config.max_jumps) wheel.healthy = false;
+            continue;
+        }
+        usable[i] = true;
+        peer_motion = std::max(peer_motion, std::abs(distances[i]));
+    }
+
+    data.count = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (!usable[i] && !repeated[i]) continue;
+        SensorStatus& wheel = status[i];
+        if (distances[i] == 0 && peer_motion > config.stuck_peer_motion) {
+            if (++wheel.still_ticks >= config.stuck_ticks) {
+                wheel.stuck++;
+                wheel.healthy = false;
+                wheel.needs_resync = true;
+                continue;
+            }
+        } else if (!repeated[i]) {
+            wheel.still_ticks = 0;
+        }
+        if (repeated[i]) continue;
+
+        TrackingWheel* sensor = sensors[i];
+        sensor->set_position(ticks[i]);
         double distance = sensor->get_distance_delta();
         double total = sensor->get_distance_total();
         double offset = sensor->get_offset();
-        data.push_back({distance, total, offset});
-    } 
-    return data;
+        data.wheels[data.count++] = {distance, total, offset};
+    }
 }
 
-static std::optional<double> calculate_wheel_heading(const std::vector<TrackingWheelData>& data) {
-    if (data.size() < 2) return std::nullopt;
-    double d_1 = data.at(0).total;
-    double d_2 = data.at(1).total;
-    double o_1 = data.at(0).offset;
-    double o_2 = data.at(1).offset;
+// Feeds the drive encoders and, if no vertical tracking wheel is healthy,
+// stands them in as one wheel on the centreline. Returns the drive heading
+// while the encoders are usable; a stale reading leaves it unchanged.
+static std::optional<double> get_drive_data(DriveEncoders* encoders, const std::array<double, 2>& degrees, bool stale,
+    bool repeat, uint64_t timestamp_us, uint64_t sample_us, uint64_t& read_us, bool wheels_healthy, SensorStatus& status,
+    const HealthConfig& config, double dt, LateralData& verticals) {
+    if (!encoders || !status.healthy) return std::nullopt;
+    if (stale) {
+        if (repeat) read_us = timestamp_us;
+        return encoders->get_heading_total();
+    }
+    const double left = degrees[0];
+    const double right = degrees[1];
+    if (!std::isfinite(left) || !std::isfinite(right)) {
+        status.errors++;
+        status.healthy = false;
+        status.needs_resync = true;
+        return std::nullopt;
+    }
+    const double interval = sample_interval(sample_us, read_us, dt);
+    if (status.needs_resync) {
+        encoders->resync(left, right);
+        status.needs_resync = false;
+    }
+    if (encoders->peek_travel(left, right) > config.max_wheel_speed * std::max(interval, MIN_HEALTH_DT)) {
+        status.jumps++;
+        encoders->resync(left, right);
+        if (status.jumps >= config.max_jumps) status.healthy = false;
+        return std::nullopt;
+    }
+
+    encoders->set_positions(left, right);
+    const double distance = encoders->get_distance_delta();
+    if (!wheels_healthy) verticals.wheels[verticals.count++] = {distance, 0, 0};
+    return encoders->get_heading_total();
+}
+
+static std::optional<double> calculate_wheel_heading(const LateralData& data) {
+    if (data.count < 2) return std::nullopt;
+    double d_1 = data.wheels[0].total;
+    double d_2 = data.wheels[1].total;
+    double o_1 = data.wheels[0].offset;
+    double o_2 = data.wheels[1].offset;
     if (std::abs(o_1-o_2) < 1e-8) return std::nullopt;
-    return (d_1 - d_2) / (o_1 - o_2);
+    // Each wheel travels -offset * heading on top of the shared translation.
+    return (d_2 - d_1) / (o_1 - o_2);
 }
 
-static std::optional<double> fuse_imus(const std::vector<pros::IMU*>& sensors) {
-    if (sensors.empty()) return std::nullopt;
+static double max_wheel_motion(const LateralData& data, double current) {
+    for (std::size_t i = 0; i < data.count; i++) current = std::max(current, std::abs(data.wheels[i].distance));
+    return current;
+}
+
+struct ImuHeading {
+    std::optional<double> heading;
+    std::size_t count;
+    std::size_t stale = 0;
+};
+
+// IMUs flagged in `stale` are skipped and counted in ImuHeading::stale.
+static ImuHeading fuse_imus(const std::array<double, Odometry::max_imus>& headings, std::size_t count, uint8_t stale,
+    const std::array<double, Odometry::max_imus>& drift_correction, std::array<SensorStatus, Odometry::max_imus>& status) {
     double sum_sin = 0, sum_cos = 0;
-    for (auto* sensor : sensors) {
-        double heading = to_radians(sensor->get_heading());
-        sum_sin += std::sin(heading);
-        sum_cos += std::cos(heading);
+    std::size_t used = 0, skipped = 0;
+    for (std::size_t i = 0; i < count; i++) {
+        if (!status[i].healthy) continue;
+        if (stale >> i & 1) {
+            skipped++;
+            continue;
+        }
+        if (!std::isfinite(headings[i])) {
+            status[i].errors++;
+            status[i].healthy = false;
+            continue;
+        }
+        used++;
+        double heading = to_radians(headings[i] - drift_correction[i]);
+        double s, c;
+        Trig::sincos(heading, s, c);
+        sum_sin += s;
+        sum_cos += c;
     }
-    return std::atan2(sum_sin, sum_cos);
+    if (used == 0) return {std::nullopt, 0, skipped};
+    return {Trig::atan2(sum_sin, sum_cos), used, skipped};
 }
 
-static std::optional<double> kalman_fuse_theta(std::vector<pros::IMU*>& imus, std::vector<TrackingWheelData>& wheel_data, double& p, double r, double q) {
-    auto imu_heading = fuse_imus(imus);
-    auto wheel_heading = calculate_wheel_heading(wheel_data);
+struct Innovation {
+    double value;
+    double variance; // predicted: prior p + r / n
+    double gain;
+};
 
+static std::optional<double> kalman_fuse_theta(const std::optional<double>& imu_heading, std::size_t imu_count,
+    const std::optional<double>& wheel_heading, double& p, double r, double q, std::optional<Innovation>& innovation) {
     if (!imu_heading && wheel_heading) return wheel_heading;
     if (!wheel_heading && imu_heading) return imu_heading;
     if (!wheel_heading && !imu_heading) return std::nullopt;
 
-    double k = p / (p + r / imus.size());
+    double s = p + r / imu_count;
+    double k = p / s;
     double theta_error = wrap_angle(imu_heading.value() - wheel_heading.value());
+    innovation = Innovation{theta_error, s, k};
     double theta_estimate = wheel_heading.value() + k * theta_error;
 
     p = (1 - k) * p + q;
@@ -67,23 +228,36 @@ struct Delta2D {
     double dy;
 };
 
+static double arc_displacement(double distance, double offset, double d_theta) {
+    return (std::abs(d_theta) < 1e-8) ? distance : 2 * Trig::sin(d_theta / 2) * ((distance / d_theta) + offset);
+}
+
+// What one wheel contributes to the tick's translation: its arc chord for
+// AverageHeading, the tracking centre's arc length for Exponential.
+static double wheel_travel(double distance, double offset, double d_theta, PoseIntegrator integrator) {
+    if (integrator == PoseIntegrator::Exponential) return distance + offset * d_theta;
+    return arc_displacement(distance, offset, d_theta);
+}
+
 static Delta2D kalman_fuse_translation (
-    const std::vector<TrackingWheelData>& horizontals, 
-    const std::vector<TrackingWheelData>& verticals, 
-    double d_theta, double& p_x, double& p_y, double r, double q) 
+    const LateralData& horizontals, 
+    const LateralData& verticals, 
+    double d_theta, double& p_x, double& p_y, double r, double q, PoseIntegrator integrator) 
 {
     double dy_sum = 0, dx_sum = 0;
     int dy_count = 0, dx_count = 0;
 
-    for (const auto& wheel : horizontals) {
-        double dy = (std::abs(d_theta) < 1e-8) ? wheel.distance : 2 * std::sin(d_theta / 2) * ((wheel.distance / d_theta) + wheel.offset);
+    for (std::size_t i = 0; i < horizontals.count; i++) {
+        const auto& wheel = horizontals.wheels[i];
+        double dy = wheel_travel(wheel.distance, wheel.offset, d_theta, integrator);
         double k = p_y / (p_y + r);
         dy_sum += k * dy;
         dy_count++;
         p_y = (1 - k) * p_y + q;
     }
-    for (const auto& wheel : verticals) {
-        double dx = (std::abs(d_theta) < 1e-8) ? wheel.distance : 2 * std::sin(d_theta / 2) * ((wheel.distance / d_theta) + wheel.offset);
+    for (std::size_t i = 0; i < verticals.count; i++) {
+        const auto& wheel = verticals.wheels[i];
+        double dx = wheel_travel(wheel.distance, wheel.offset, d_theta, integrator);
         double k = p_x / (p_x + r);
         dx_sum += k * dx;
         dx_count++;
@@ -95,12 +269,61 @@ static Delta2D kalman_fuse_translation (
     return {dx, dy};
 }
 
-static void update_global_pose(Pose& pose, const Delta2D& d_translation, double heading) {
-    double avg_theta = pose.heading + (heading - pose.heading) / 2.0;
-    double dx_global = std::cos(avg_theta) * d_translation.dx - std::sin(avg_theta) * d_translation.dy;
-    double dy_global = std::sin(avg_theta) * d_translation.dx + std::cos(avg_theta) * d_translation.dy;
-    pose.x += dx_global;
-    pose.y += dy_global;
+static Delta2D average_translation(const LateralData& horizontals, const LateralData& verticals, double d_theta, PoseIntegrator integrator) {
+    double dx = 0, dy = 0;
+    for (std::size_t i = 0; i < horizontals.count; i++)
+        dy += wheel_travel(horizontals.wheels[i].distance, horizontals.wheels[i].offset, d_theta, integrator);
+    for (std::size_t i = 0; i < verticals.count; i++)
+        dx += wheel_travel(verticals.wheels[i].distance, verticals.wheels[i].offset, d_theta, integrator);
+    if (horizontals.count) dy /= horizontals.count;
+    if (verticals.count) dx /= verticals.count;
+    return {dx, dy};
+}
+
+// Translation variance of one wheel, from how far the first two wheels on an
+// axis disagree about `d_theta` (the spread between them should be
+// (o_2 - o_1) * d_theta, as in calculate_wheel_heading). Per unit of travel
+// when `per_travel` is set.
+static std::optional<double> wheel_disagreement(const LateralData& horizontals, const LateralData& verticals, double d_theta, bool per_travel) {
+    double sum = 0;
+    int axes = 0;
+    for (const auto* data : {&horizontals, &verticals}) {
+        if (data->count < 2) continue;
+        const auto& a = data->wheels[0];
+        const auto& b = data->wheels[1];
+        double residual = (a.distance - b.distance) + (a.offset - b.offset) * d_theta;
+        double variance = residual * residual / 2;
+        if (per_travel) {
+            double travel = (std::abs(a.distance) + std::abs(b.distance)) / 2;
+            if (travel < MIN_ADAPTATION_TRAVEL) continue;
+            variance /= travel;
+        }
+        sum += variance;
+        axes++;
+    }
+    if (axes == 0) return std::nullopt;
+    return sum / axes;
+}
+
+static double adapt(double current, double nominal, double& average, double sample, const NoiseAdaptation& config) {
+    average += (sample - average) / std::max(config.window, 1.0);
+    double target = std::clamp(average, nominal * config.min_scale, nominal * config.max_scale);
+    return std::clamp(target, current / (1 + config.max_rate), current * (1 + config.max_rate));
+}
+
+// Pose after moving by `d_translation` (as produced by wheel_travel) while
+// turning by `d_theta`.
+static Vec3 integrate_pose(const Vec3& pose, const Delta2D& d_translation, double d_theta, PoseIntegrator integrator) {
+    if (integrator == PoseIntegrator::Exponential) return integrate_exponential(pose, {d_translation.dx, d_translation.dy, d_theta});
+    double s, c;
+    Trig::sincos(pose[2] + d_theta / 2.0, s, c);
+    return {pose[0] + c * d_translation.dx - s * d_translation.dy, pose[1] + s * d_translation.dx + c * d_translation.dy, pose[2] + d_theta};
+}
+
+static void update_global_pose(Pose& pose, const Delta2D& d_translation, double heading, double d_theta, PoseIntegrator integrator) {
+    Vec3 next = integrate_pose({pose.x, pose.y, pose.heading}, d_translation, d_theta, integrator);
+    pose.x = next[0];
+    pose.y = next[1];
     pose.heading = heading;
 }
 
@@ -109,21 +332,413 @@ Odometry::Odometry(std::vector<pros::IMU*> imus,
     std::vector<TrackingWheel*> h_wheels,
     double p_x, double p_y, double p_theta,
     double r_translation, double r_heading, double q) : 
-    imus(imus),
-    v_wheels(v_wheels),
-    h_wheels(h_wheels),
+    imu_count(copy_sensors(Odometry::imus, imus)),
+    v_wheel_count(copy_sensors(Odometry::v_wheels, v_wheels)),
+    h_wheel_count(copy_sensors(Odometry::h_wheels, h_wheels)),
     p_x(p_x), p_y(p_y), p_theta(p_theta),
-    r_translation(r_translation), r_heading(r_heading), q(q) {}
+    r_translation(r_translation), r_heading(r_heading), q(q),
+    nominal_noise{r_translation, r_heading, q},
+    noise_average{r_translation, r_heading, q},
+    noise({r_translation, r_heading, q}),
+    covariance(Mat3::diagonal(p_x, p_y, p_theta)) {
+    health.ignored_sensors = imus.size() - imu_count + v_wheels.size() - v_wheel_count + h_wheels.size() - h_wheel_count;
+    if (health.ignored_sensors) {
+        std::fprintf(stderr, "Odometry: ignoring %zu sensors beyond %zu IMUs and %zu wheels per axis\n",
+                     health.ignored_sensors, max_imus, max_wheels);
+    }
+    health_snapshot.store(health);
+}
+
+void Odometry::update(Pose& pose, const Inputs& inputs) {
+    const uint64_t timestamp_us = inputs.timestamp_us;
+    double dt = 0;
+    if (last_update_us) {
+        dt = (timestamp_us - last_update_us) / 1e6;
+        for (std::size_t i = 0; i < imu_count; i++) imu_drift_correction[i] += imu_drift.get(i).rate * dt;
+    }
+    last_update_us = timestamp_us;
+
+    const Vec3 before = {pose.x, pose.y, pose.heading};
+    update_pose(pose, inputs, dt);
+    if (slip_config.enabled) detect_slip(inputs, wrap_angle(pose.heading - before[2]));
 
-void Odometry::update(Pose& pose) {
-    auto h_wheel_data = get_lateral_data(h_wheels);
-    auto v_wheel_data = get_lateral_data(v_wheels);
-    auto heading = kalman_fuse_theta(imus, h_wheel_data, p_theta, r_heading, q);
+    const Pose dead_reckoned = dead_reckoning.load();
+    const Vec3 moved = transfer_pose({pose.x, pose.y, pose.heading}, before, {dead_reckoned.x, dead_reckoned.y, dead_reckoned.heading});
+    dead_reckoning.store(Pose(moved[0], moved[1], moved[2]));
+    history.push(timestamp_us, {pose.x, pose.y, pose.heading}, get_covariance());
+
+    while (auto measurement = measurements.pop()) {
+        fuse_measurement(pose, measurement.value());
+    }
+    health_snapshot.store(health);
+}
+
+void Odometry::update_pose(Pose& pose, const Inputs& inputs, double dt) {
+    LateralData h_wheel_data, v_wheel_data;
+    get_lateral_data(h_wheels, inputs.h_ticks, inputs.h_stale, inputs.h_repeat, inputs.timestamp_us, inputs.h_sample_us,
+                     h_read_us, h_wheel_count, health.h_wheels, health_config, dt, h_wheel_data);
+    get_lateral_data(v_wheels, inputs.v_ticks, inputs.v_stale, inputs.v_repeat, inputs.timestamp_us, inputs.v_sample_us,
+                     v_read_us, v_wheel_count, health.v_wheels, health_config, dt, v_wheel_data);
+    tracked_verticals = v_wheel_data;
+    const bool v_wheels_healthy = std::any_of(health.v_wheels.begin(), health.v_wheels.begin() + v_wheel_count,
+                                              [](const SensorStatus& status) { return status.healthy; });
+    auto drive_heading = get_drive_data(drive_encoders, inputs.drive_degrees, inputs.drive_stale, inputs.drive_repeat,
+                                        inputs.timestamp_us, inputs.drive_sample_us, drive_read_us, v_wheels_healthy,
+                                        health.drive, health_config, dt, v_wheel_data);
+    drive_usable = drive_heading.has_value();
+    drive_sampled = drive_usable && !inputs.drive_stale;
+
+    // A pair that is only incomplete because a wheel is stale keeps its last
+    // heading rather than dropping out for the tick.
+    auto wheel_heading = calculate_wheel_heading(h_wheel_data);
+    std::size_t stale_h_wheels = 0;
+    for (std::size_t i = 0; i < h_wheel_count; i++) stale_h_wheels += health.h_wheels[i].healthy && (inputs.h_stale >> i & 1);
+    if (!wheel_heading && h_wheel_data.count + stale_h_wheels >= 2) wheel_heading = held_wheel_heading;
+    held_wheel_heading = wheel_heading;
+    last_wheel_motion = max_wheel_motion(v_wheel_data, max_wheel_motion(h_wheel_data, 0));
+
+    if (filter == OdometryFilter::Ekf) {
+        update_ekf(pose, inputs, h_wheel_data, v_wheel_data, wheel_heading, drive_heading);
+        return;
+    }
+
+    // The scalar filter is a blend rather than a measurement update, so it
+    // keeps blending the latest IMU value between fresh readings.
+    auto imu_heading = fuse_imus(inputs.imu_headings, imu_count, 0, imu_drift_correction, health.imus);
+    std::optional<Innovation> innovation;
+    auto heading = kalman_fuse_theta(imu_heading.heading, imu_heading.count, wheel_heading, p_theta, r_heading, q, innovation);
+    if (!heading) heading = drive_heading;
 
     if (!heading) return; // or handle error
 
+    last_raw_heading = heading.value();
+    heading = wrap_angle(heading.value() + heading_offset);
+
     double d_theta = wrap_angle(heading.value() - pose.heading);
-    auto d_translation = kalman_fuse_translation(h_wheel_data, v_wheel_data, d_theta, p_x, p_y, r_translation, q);
+    auto d_translation = kalman_fuse_translation(h_wheel_data, v_wheel_data, d_theta, p_x, p_y, r_translation, q, integrator);
+
+    update_global_pose(pose, d_translation, heading.value(), d_theta, integrator);
+
+    if (noise_adaptation.enabled) {
+        std::optional<double> r_heading_sample, q_sample;
+        if (innovation) {
+            double v = innovation->value;
+            r_heading_sample = imu_heading.count * (v * v - innovation->variance) + r_heading;
+            q_sample = innovation->gain * innovation->gain * v * v;
+        }
+        adapt_noise(wheel_disagreement(h_wheel_data, v_wheel_data, d_theta, false), r_heading_sample, q_sample);
+    }
+}
+
+void Odometry::reset(const Pose& pose) {
+    if (recording()) {
+        OdometryLogRecord record;
+        record.event = OdometryLogEvent::Reset;
+        record.pose = pose;
+        log_record(record);
+    }
+    heading_offset = wrap_angle(pose.heading - last_raw_heading);
+    history.clear();
+
+    for (auto* statuses : {&health.v_wheels, &health.h_wheels}) {
+        for (auto& status : *statuses) {
+            if (status.healthy) continue;
+            status.healthy = true;
+            status.needs_resync = true;
+            status.jumps = 0;
+            status.still_ticks = 0;
+        }
+    }
+    for (auto& status : health.imus) status.healthy = true;
+    if (!health.drive.healthy) {
+        health.drive.healthy = true;
+        health.drive.needs_resync = true;
+        health.drive.jumps = 0;
+    }
+    health_snapshot.store(health);
+}
+
+bool Odometry::submit_measurement(const PoseMeasurement& measurement) {
+    return measurements.push(measurement);
+}
+
+static double mahalanobis_squared(const PoseMeasurement& measurement, const PoseSample& past) {
+    const Mat3& p = past.covariance;
+    double distance = 0;
+    if (measurement.x && measurement.y) {
+        double nx = measurement.x.value() - past.state[0];
+        double ny = measurement.y.value() - past.state[1];
+        double sxx = p(0, 0) + measurement.variance_xy;
+        double syy = p(1, 1) + measurement.variance_xy;
+        double sxy = p(0, 1);
+        double det = sxx * syy - sxy * sxy;
+        if (det > 0) distance += (syy * nx * nx - 2 * sxy * nx * ny + sxx * ny * ny) / det;
+    } else if (measurement.x || measurement.y) {
+        std::size_t i = measurement.x ? 0 : 1;
+        double n = (measurement.x ? measurement.x.value() : measurement.y.value()) - past.state[i];
+        distance += n * n / (p(i, i) + measurement.variance_xy);
+    }
+    if (measurement.heading) {
+        double n = wrap_angle(measurement.heading.value() - past.state[2]);
+        distance += n * n / (p(2, 2) + measurement.variance_heading);
+    }
+    return distance;
+}
+
+bool Odometry::fuse_measurement(Pose& pose, const PoseMeasurement& measurement) {
+    if (recording()) {
+        OdometryLogRecord record;
+        record.event = OdometryLogEvent::Measurement;
+        record.measurement = measurement;
+        log_record(record);
+    }
+    auto past = history.at(measurement.timestamp_us);
+    if (!past || (measurement.gate > 0 && mahalanobis_squared(measurement, past.value()) > measurement.gate)) {
+        measurement_stats.rejected++;
+        measurement_stats_snapshot.store(measurement_stats);
+        return false;
+    }
+    measurement_stats.accepted++;
+    measurement_stats_snapshot.store(measurement_stats);
+
+    Vec3 corrected = past->state;
+    Mat3 corrected_covariance = past->covariance;
+    if (measurement.x) scalar_update(corrected, corrected_covariance, 0, measurement.x.value() - corrected[0], measurement.variance_xy);
+    if (measurement.y) scalar_update(corrected, corrected_covariance, 1, measurement.y.value() - corrected[1], measurement.variance_xy);
+    if (measurement.heading) scalar_update(corrected, corrected_covariance, 2, wrap_angle(measurement.heading.value() - corrected[2]), measurement.variance_heading);
+    corrected[2] = wrap_angle(corrected[2]);
+
+    // Carry the correction from capture time to now: everything integrated
+    // since then is relative motion, so it moves rigidly with the past pose.
+    Mat3 reduction = past->covariance - corrected_covariance;
+    Vec3 current = transfer_pose({pose.x, pose.y, pose.heading}, past->state, corrected);
+    history.apply_correction(measurement.timestamp_us, past->state, corrected, reduction);
+    set_covariance(symmetrize(get_covariance() - reduction));
+    heading_offset = wrap_angle(heading_offset + wrap_angle(corrected[2] - past->state[2]));
+
+    pose = Pose(current[0], current[1], current[2]);
+    return true;
+}
+
+void Odometry::update_ekf(Pose& pose, const Inputs& inputs, const LateralData& h_wheel_data, const LateralData& v_wheel_data,
+    const std::optional<double>& wheel_heading, const std::optional<double>& drive_heading) {
+    auto fused_imus = fuse_imus(inputs.imu_headings, imu_count, inputs.imu_stale, imu_drift_correction, health.imus);
+    auto imu_heading = fused_imus.heading;
+
+    // Heading change for the motion model comes from the wheels when possible,
+    // leaving the IMU as an independent measurement.
+    double d_theta = 0;
+    if (wheel_heading && last_wheel_heading) d_theta = wrap_angle(wheel_heading.value() - last_wheel_heading.value());
+    else if (imu_heading && last_imu_heading) d_theta = wrap_angle(imu_heading.value() - last_imu_heading.value());
+    else if (fused_imus.stale == 0 && drive_heading && last_drive_heading) d_theta = wrap_angle(drive_heading.value() - last_drive_heading.value());
+    last_wheel_heading = wheel_heading;
+    // Between fresh IMU readings keep the last one, so the next d_theta
+    // spans the whole gap.
+    if (imu_heading || fused_imus.stale == 0) last_imu_heading = imu_heading;
+    last_drive_heading = drive_heading;
+    if (imu_heading) last_raw_heading = imu_heading.value();
+
+    Delta2D d_translation = average_translation(h_wheel_data, v_wheel_data, d_theta, integrator);
+
+    // Predict
+    const Vec3 prior = {pose.x, pose.y, pose.heading};
+    Vec3 state = integrate_pose(prior, d_translation, d_theta, integrator);
+    state[2] = wrap_angle(state[2]);
+
+    // The global displacement rotates rigidly with the starting heading.
+    Mat3 jacobian = Mat3::identity();
+    jacobian(0, 2) = -(state[1] - prior[1]);
+    jacobian(1, 2) = state[0] - prior[0];
+
+    double travel = std::abs(d_translation.dx) + std::abs(d_translation.dy);
+    Mat3 process_noise = Mat3::diagonal(r_translation * travel, r_translation * travel, q);
+    covariance = sandwich(jacobian, covariance) + process_noise;
+
+    // Correct
+    std::optional<double> r_heading_sample, q_sample;
+    if (imu_heading) {
+        double measured = wrap_angle(imu_heading.value() + heading_offset);
+        double innovation = wrap_angle(measured - state[2]);
+        double prior = covariance(2, 2);
+        double gain = prior / (prior + r_heading / fused_imus.count);
+        scalar_update(state, covariance, 2, innovation, r_heading / fused_imus.count);
+        state[2] = wrap_angle(state[2]);
+        r_heading_sample = fused_imus.count * (innovation * innovation - prior);
+        q_sample = gain * gain * innovation * innovation;
+    }
+    covariance = symmetrize(covariance);
+
+    pose = Pose(state[0], state[1], state[2]);
+
+    if (noise_adaptation.enabled) {
+        adapt_noise(wheel_disagreement(h_wheel_data, v_wheel_data, d_theta, true), r_heading_sample, q_sample);
+    }
+}
+
+// The drive encoders update less often than the tracking wheels, so each
+// fresh drive delta spans several ticks. Wheel travel and heading change are
+// accumulated over the same window and the two are compared once per fresh
+// drive sample.
+void Odometry::detect_slip(const Inputs& inputs, double d_theta) {
+    if (!drive_encoders) return;
+    if (!drive_usable) {
+        // Resynced or failed: the next fresh delta starts from here.
+        slip_window = {inputs.timestamp_us, 0, 0, false};
+        return;
+    }
+
+    if (tracked_verticals.count) {
+        double travel = 0;
+        for (std::size_t i = 0; i < tracked_verticals.count; i++) {
+            travel += tracked_verticals.wheels[i].distance + tracked_verticals.wheels[i].offset * d_theta;
+        }
+        slip_window.travel += travel / tracked_verticals.count;
+        slip_window.tracked = true;
+    }
+    slip_window.turn += d_theta;
+    if (!drive_sampled) return;
+
+    const SlipWindow window = slip_window;
+    slip_window = {inputs.drive_sample_us, 0, 0, false};
+    const double dt = window.start_us ? (inputs.drive_sample_us - window.start_us) / 1e6 : 0;
+    if (!window.tracked || dt <= 0) return;
+
+    double accel = 0;
+    for (std::size_t i = 0; i < imu_count; i++) {
+        if (health.imus[i].healthy && std::isfinite(inputs.imu_accels[i])) accel = std::max(accel, inputs.imu_accels[i]);
+    }
+
+    // Heading is clockwise positive, so the left side covers the extra arc.
+    const double half_track = drive_encoders->get_config().track_width / 2;
+    const auto sides = drive_encoders->get_side_deltas();
+    slip.store(slip_detector.update(sides[0], sides[1], window.travel + window.turn * half_track,
+                                    window.travel - window.turn * half_track, accel, dt, slip_config));
+}
+
+void Odometry::adapt_noise(const std::optional<double>& r_translation_sample, const std::optional<double>& r_heading_sample,
+    const std::optional<double>& q_sample) {
+    if (r_translation_sample) {
+        r_translation = adapt(r_translation, nominal_noise.r_translation, noise_average.r_translation, r_translation_sample.value(), noise_adaptation);
+    }
+    if (r_heading_sample) {
+        r_heading = adapt(r_heading, nominal_noise.r_heading, noise_average.r_heading, r_heading_sample.value(), noise_adaptation);
+    }
+    if (q_sample) q = adapt(q, nominal_noise.q, noise_average.q, q_sample.value(), noise_adaptation);
+    noise.store({r_translation, r_heading, q});
+}
+
+void Odometry::set_noise_adaptation(const NoiseAdaptation& config) {
+    noise_adaptation = config;
+    noise_average = nominal_noise;
+    if (!config.enabled) {
+        r_translation = nominal_noise.r_translation;
+        r_heading = nominal_noise.r_heading;
+        q = nominal_noise.q;
+        noise.store(nominal_noise);
+    }
+}
+
+void Odometry::set_slip_detection(const SlipConfig& config) {
+    slip_config = config;
+    slip_detector.reset();
+    slip_window = {};
+    slip.store({0, 0, 0, false});
+}
+
+SlipEstimate Odometry::get_slip() const {
+    return slip.load();
+}
+
+NoiseEstimate Odometry::get_noise() const {
+    return noise.load();
+}
+
+void Odometry::set_filter(OdometryFilter filter) {
+    Odometry::filter = filter;
+}
+
+void Odometry::set_integrator(PoseIntegrator integrator) {
+    Odometry::integrator = integrator;
+}
+
+void Odometry::set_drive_encoders(DriveEncoders* drive_encoders) {
+    Odometry::drive_encoders = drive_encoders;
+}
+
+Mat3 Odometry::get_covariance() const {
+    if (filter == OdometryFilter::Scalar) return Mat3::diagonal(p_x, p_y, p_theta);
+    return covariance;
+}
+
+void Odometry::set_covariance(const Mat3& covariance) {
+    if (filter == OdometryFilter::Scalar) {
+        p_x = covariance(0, 0);
+        p_y = covariance(1, 1);
+        p_theta = covariance(2, 2);
+        return;
+    }
+    Odometry::covariance = covariance;
+}
+
+MeasurementStats Odometry::get_measurement_stats() const {
+    return measurement_stats_snapshot.load();
+}
 
-    update_global_pose(pose, d_translation, heading.value());
-}
\ No newline at end of file
+Pose Odometry::get_dead_reckoned_pose() const {
+    return dead_reckoning.load();
+}
+
+ImuDrift Odometry::get_imu_drift(std::size_t index) const {
+    return imu_drift.get(index);
+}
+
+void Odometry::set_imu_drift(std::size_t index, const ImuDrift& drift) {
+    if (index < imu_count) imu_drift.set(index, drift);
+}
+
+bool Odometry::recording() const {
+    return recorder.load(std::memory_order_relaxed) != nullptr;
+}
+
+// recorder_busy is raised before the pointer is loaded, so set_recorder()
+// either sees this call in flight or this call sees the new pointer.
+void Odometry::log_record(const OdometryLogRecord& record) {
+    recorder_busy.store(true);
+    if (OdometryRecorder* current = recorder.load()) current->record(record);
+    recorder_busy.store(false, std::memory_order_release);
+}
+
+OdometryLogHeader Odometry::get_log_header() const {
+    OdometryLogHeader header = {};
+    header.imu_count = imu_count;
+    header.v_wheel_count = v_wheel_count;
+    header.h_wheel_count = h_wheel_count;
+    for (std::size_t i = 0; i < v_wheel_count; i++) header.v_wheels[i] = {v_wheels[i]->get_diameter(), v_wheels[i]->get_offset()};
+    for (std::size_t i = 0; i < h_wheel_count; i++) header.h_wheels[i] = {h_wheels[i]->get_diameter(), h_wheels[i]->get_offset()};
+    for (std::size_t i = 0; i < imu_count; i++) header.imu_drift_rates[i] = imu_drift.get(i).rate;
+    header.has_drive = drive_encoders != nullptr;
+    if (drive_encoders) header.drive = drive_encoders->get_config();
+    header.filter = static_cast<uint8_t>(filter);
+    header.p_x = p_x;
+    header.p_y = p_y;
+    header.p_theta = p_theta;
+    header.r_translation = r_translation;
+    header.r_heading = r_heading;
+    header.q = q;
+    header.integrator = static_cast<uint8_t>(integrator);
+    header.noise_adaptation = noise_adaptation;
+    header.health = health_config;
+    return header;
+}
+
+void Odometry::set_health_config(const HealthConfig& config) {
+    health_config = config;
+}
+
+Odometry::Health Odometry::get_health() const {
+    return health_snapshot.load();
+}
+
+Odometry::Sampling Odometry::get_sampling() const {
+    return sampling_snapshot.load();
+}
@@ -0,0 +1,134 @@
+// Odometry members that talk to V5 devices or wait on the RTOS. Kept apart
+// from odometry.cpp so the filter itself builds on the host for log replay.
+#include "odometry.h"
+#include "device_sampling.h"
+#include "drive_encoders.h"
+#include "odometry_recorder.h"
+#include "pros/gps.hpp"
+#include "pros/imu.hpp"
+#include "pros/motor_group.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "utils/angle.h"
+#include <array>
+#include <cmath>
+
+static constexpr double STATIONARY_WHEEL_DELTA = 0.002;
+
+Odometry::Inputs Odometry::sample() {
+    Inputs inputs = last_inputs;
+    const uint64_t now = pros::micros();
+    inputs.timestamp_us = now;
+    inputs.v_stale = inputs.h_stale = inputs.imu_stale = 0;
+    inputs.v_repeat = inputs.h_repeat = 0;
+
+    for (std::size_t i = 0; i < v_wheel_count; i++) {
+        flag_sample(sample_device(now, schedule.rotation_period_ms, v_due[i], sampling.v_wheels[i], inputs.v_ticks[i],
+                                  inputs.v_sample_us[i], [&] { return v_wheels[i]->get_encoder()->get_position(); }),
+                    i, inputs.v_stale, inputs.v_repeat);
+    }
+    for (std::size_t i = 0; i < h_wheel_count; i++) {
+        flag_sample(sample_device(now, schedule.rotation_period_ms, h_due[i], sampling.h_wheels[i], inputs.h_ticks[i],
+                                  inputs.h_sample_us[i], [&] { return h_wheels[i]->get_encoder()->get_position(); }),
+                    i, inputs.h_stale, inputs.h_repeat);
+    }
+    for (std::size_t i = 0; i < imu_count; i++) {
+        if (sample_device(now, schedule.imu_period_ms, imu_due[i], sampling.imus[i], inputs.imu_headings[i],
+                          inputs.imu_sample_us[i], [&] { return imus[i]->get_heading(); }) != SampleResult::Fresh) {
+            inputs.imu_stale |= 1u << i;
+        }
+    }
+    if (slip_config.enabled) {
+        for (std::size_t i = 0; i < imu_count; i++) {
+            const auto accel = imus[i]->get_accel();
+            inputs.imu_accels[i] = std::hypot(accel.x, accel.y);
+        }
+    }
+    if (drive_encoders) {
+        const SampleResult result = sample_device(now, schedule.motor_period_ms, drive_due, sampling.drive,
+                                                  inputs.drive_degrees, inputs.drive_sample_us, [&] {
+            return std::array<double, 2>{median_position(drive_encoders->get_left_motors()),
+                                         median_position(drive_encoders->get_right_motors())};
+        });
+        inputs.drive_stale = result != SampleResult::Fresh;
+        inputs.drive_repeat = result == SampleResult::Repeat;
+    }
+    last_inputs = inputs;
+    sampling_snapshot.store(sampling);
+    return inputs;
+}
+
+void Odometry::update(Pose& pose) {
+    const Inputs inputs = sample();
+    update(pose, inputs);
+
+    if (gps && inputs.timestamp_us - last_gps_us >= gps_config.period_ms * 1000ull) {
+        last_gps_us = inputs.timestamp_us;
+        if (auto measurement = sample_gps(inputs.timestamp_us)) fuse_measurement(pose, measurement.value());
+    }
+    // After the tick's measurements, so a replay has them queued when it
+    // runs update() on these inputs.
+    if (recording()) {
+        OdometryLogRecord record;
+        record.inputs = inputs;
+        log_record(record);
+    }
+}
+
+void Odometry::set_recorder(OdometryRecorder* recorder) {
+    Odometry::recorder.store(recorder);
+    while (recorder_busy.load()) pros::delay(1);
+}
+
+void Odometry::set_sample_schedule(const SampleSchedule& schedule) {
+    Odometry::schedule = schedule;
+    for (std::size_t i = 0; i < v_wheel_count; i++) v_wheels[i]->get_encoder()->set_data_rate(schedule.rotation_period_ms);
+    for (std::size_t i = 0; i < h_wheel_count; i++) h_wheels[i]->get_encoder()->set_data_rate(schedule.rotation_period_ms);
+    for (std::size_t i = 0; i < imu_count; i++) imus[i]->set_data_rate(schedule.imu_period_ms);
+}
+
+void Odometry::set_gps(pros::Gps* gps, GpsConfig config) {
+    Odometry::gps = gps;
+    gps_config = config;
+    last_gps_us = 0;
+}
+
+std::optional<PoseMeasurement> Odometry::sample_gps(uint64_t timestamp_us) {
+    double error = gps->get_error();
+    double x = gps->get_position_x();
+    double y = gps->get_position_y();
+    double heading = gps->get_heading();
+    if (!std::isfinite(error) || !std::isfinite(x) || !std::isfinite(y) || !std::isfinite(heading)) return std::nullopt;
+
+    double sigma = error * gps_config.units_per_meter;
+    return PoseMeasurement {
+        timestamp_us - gps_config.latency_ms * 1000ull,
+        x * gps_config.units_per_meter,
+        y * gps_config.units_per_meter,
+        to_radians(heading),
+        sigma * sigma,
+        gps_config.variance_heading,
+        gps_config.gate
+    };
+}
+
+void Odometry::learn_imu_drift(bool motors_still) {
+    if (!motors_still || last_wheel_motion > STATIONARY_WHEEL_DELTA) {
+        imu_drift.interrupt();
+        return;
+    }
+
+    for (std::size_t i = 0; i < imu_count; i++) {
+        double rotation = imus[i]->get_rotation();
+        if (!std::isfinite(rotation)) continue;
+        const double rate = imu_drift.get(i).rate;
+        imu_drift.sample(i, rotation, last_update_us);
+        if (recording() && imu_drift.get(i).rate != rate) {
+            OdometryLogRecord record;
+            record.event = OdometryLogEvent::ImuDrift;
+            record.imu = i;
+            record.drift = imu_drift.get(i);
+            log_record(record);
+        }
+    }
+}
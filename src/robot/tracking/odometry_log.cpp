@@ -0,0 +1,207 @@
+#include "odometry_log.h"
+#include <cstring>
+#include <initializer_list>
+#include <optional>
+
+static constexpr char MAGIC[4] = {'O', 'D', 'L', 'G'};
+static constexpr uint16_t VERSION = 6;
+
+template <typename T>
+static bool write_value(std::FILE* file, const T& value) {
+    return std::fwrite(&value, sizeof(T), 1, file) == 1;
+}
+
+template <typename T>
+static bool read_value(std::FILE* file, T& value) {
+    return std::fread(&value, sizeof(T), 1, file) == 1;
+}
+
+bool write_log_header(std::FILE* file, const OdometryLogHeader& header) {
+    bool ok = std::fwrite(MAGIC, sizeof(MAGIC), 1, file) == 1;
+    ok = ok && write_value(file, VERSION);
+    ok = ok && write_value(file, header.imu_count) && write_value(file, header.v_wheel_count);
+    ok = ok && write_value(file, header.h_wheel_count) && write_value(file, header.filter);
+    ok = ok && write_value(file, header.has_drive);
+    for (std::size_t i = 0; i < header.v_wheel_count; i++) {
+        ok = ok && write_value(file, header.v_wheels[i].diameter) && write_value(file, header.v_wheels[i].offset);
+    }
+    for (std::size_t i = 0; i < header.h_wheel_count; i++) {
+        ok = ok && write_value(file, header.h_wheels[i].diameter) && write_value(file, header.h_wheels[i].offset);
+    }
+    for (std::size_t i = 0; i < header.imu_count; i++) ok = ok && write_value(file, header.imu_drift_rates[i]);
+    if (header.has_drive) {
+        for (double value : {header.drive.wheel_diameter, header.drive.gear_ratio, header.drive.track_width}) {
+            ok = ok && write_value(file, value);
+        }
+    }
+    for (double value : {header.p_x, header.p_y, header.p_theta, header.r_translation, header.r_heading, header.q}) {
+        ok = ok && write_value(file, value);
+    }
+    const NoiseAdaptation& adaptation = header.noise_adaptation;
+    const uint8_t adaptation_enabled = adaptation.enabled;
+    ok = ok && write_value(file, header.integrator) && write_value(file, adaptation_enabled);
+    for (double value : {adaptation.window, adaptation.max_rate, adaptation.min_scale, adaptation.max_scale,
+                         header.health.max_wheel_speed}) {
+        ok = ok && write_value(file, value);
+    }
+    ok = ok && write_value(file, header.health.max_jumps) && write_value(file, header.health.stuck_ticks);
+    ok = ok && write_value(file, header.health.stuck_peer_motion);
+    return ok;
+}
+
+static bool write_inputs(std::FILE* file, const OdometryLogHeader& header, const Odometry::Inputs& inputs) {
+    bool ok = write_value(file, inputs.timestamp_us);
+    for (std::size_t i = 0; i < header.v_wheel_count; i++) ok = ok && write_value(file, inputs.v_ticks[i]);
+    for (std::size_t i = 0; i < header.h_wheel_count; i++) ok = ok && write_value(file, inputs.h_ticks[i]);
+    for (std::size_t i = 0; i < header.imu_count; i++) ok = ok && write_value(file, inputs.imu_headings[i]);
+    if (header.has_drive) ok = ok && write_value(file, inputs.drive_degrees[0]) && write_value(file, inputs.drive_degrees[1]);
+    const uint8_t drive_stale = inputs.drive_stale;
+    ok = ok && write_value(file, inputs.v_stale) && write_value(file, inputs.h_stale);
+    ok = ok && write_value(file, inputs.imu_stale) && write_value(file, drive_stale);
+    const uint8_t drive_repeat = inputs.drive_repeat;
+    ok = ok && write_value(file, inputs.v_repeat) && write_value(file, inputs.h_repeat) && write_value(file, drive_repeat);
+    return ok;
+}
+
+static bool write_measurement(std::FILE* file, const PoseMeasurement& measurement) {
+    const uint8_t present = measurement.x.has_value() | measurement.y.has_value() << 1 | measurement.heading.has_value() << 2;
+    bool ok = write_value(file, measurement.timestamp_us) && write_value(file, present);
+    for (const auto* component : {&measurement.x, &measurement.y, &measurement.heading}) {
+        if (*component) ok = ok && write_value(file, component->value());
+    }
+    for (double value : {measurement.variance_xy, measurement.variance_heading, measurement.gate}) {
+        ok = ok && write_value(file, value);
+    }
+    return ok;
+}
+
+bool write_log_record(std::FILE* file, const OdometryLogHeader& header, const OdometryLogRecord& record) {
+    bool ok = write_value(file, record.event);
+    switch (record.event) {
+        case OdometryLogEvent::Inputs:
+            return ok && write_inputs(file, header, record.inputs);
+        case OdometryLogEvent::Reset:
+            for (double value : {record.pose.x, record.pose.y, record.pose.heading}) ok = ok && write_value(file, value);
+            return ok;
+        case OdometryLogEvent::Measurement:
+            return ok && write_measurement(file, record.measurement);
+        case OdometryLogEvent::ImuDrift:
+            ok = ok && write_value(file, record.imu);
+            return ok && write_value(file, record.drift.rate) && write_value(file, record.drift.learned_s);
+        case OdometryLogEvent::Dropped:
+            return ok && write_value(file, record.dropped);
+    }
+    return false;
+}
+
+bool read_log_header(std::FILE* file, OdometryLogHeader& header) {
+    char magic[4];
+    uint16_t version;
+    header = {};
+    if (std::fread(magic, sizeof(magic), 1, file) != 1 || std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0) return false;
+    if (!read_value(file, version) || version < 1 || version > VERSION) return false;
+    header.version = version;
+
+    bool ok = read_value(file, header.imu_count) && read_value(file, header.v_wheel_count);
+    ok = ok && read_value(file, header.h_wheel_count) && read_value(file, header.filter);
+    if (version >= 2) ok = ok && read_value(file, header.has_drive);
+    ok = ok && header.imu_count <= Odometry::max_imus;
+    ok = ok && header.v_wheel_count <= Odometry::max_wheels && header.h_wheel_count <= Odometry::max_wheels;
+    for (std::size_t i = 0; ok && i < header.v_wheel_count; i++) {
+        ok = read_value(file, header.v_wheels[i].diameter) && read_value(file, header.v_wheels[i].offset);
+    }
+    for (std::size_t i = 0; ok && i < header.h_wheel_count; i++) {
+        ok = read_value(file, header.h_wheels[i].diameter) && read_value(file, header.h_wheels[i].offset);
+    }
+    for (std::size_t i = 0; ok && i < header.imu_count; i++) ok = read_value(file, header.imu_drift_rates[i]);
+    if (ok && header.has_drive) {
+        ok = read_value(file, header.drive.wheel_diameter) && read_value(file, header.drive.gear_ratio);
+        ok = ok && read_value(file, header.drive.track_width);
+    }
+    for (double* value : {&header.p_x, &header.p_y, &header.p_theta, &header.r_translation, &header.r_heading, &header.q}) {
+        ok = ok && read_value(file, *value);
+    }
+    if (ok && version >= 4) {
+        NoiseAdaptation& adaptation = header.noise_adaptation;
+        uint8_t adaptation_enabled;
+        ok = read_value(file, header.integrator) && read_value(file, adaptation_enabled);
+        adaptation.enabled = adaptation_enabled;
+        for (double* value : {&adaptation.window, &adaptation.max_rate, &adaptation.min_scale, &adaptation.max_scale,
+                              &header.health.max_wheel_speed}) {
+            ok = ok && read_value(file, *value);
+        }
+        ok = ok && read_value(file, header.health.max_jumps) && read_value(file, header.health.stuck_ticks);
+        ok = ok && read_value(file, header.health.stuck_peer_motion);
+    }
+    return ok;
+}
+
+static bool read_inputs(std::FILE* file, const OdometryLogHeader& header, Odometry::Inputs& inputs) {
+    inputs = {};
+    bool ok = read_value(file, inputs.timestamp_us);
+    for (std::size_t i = 0; ok && i < header.v_wheel_count; i++) ok = read_value(file, inputs.v_ticks[i]);
+    for (std::size_t i = 0; ok && i < header.h_wheel_count; i++) ok = read_value(file, inputs.h_ticks[i]);
+    for (std::size_t i = 0; ok && i < header.imu_count; i++) ok = read_value(file, inputs.imu_headings[i]);
+    if (ok && header.has_drive) ok = read_value(file, inputs.drive_degrees[0]) && read_value(file, inputs.drive_degrees[1]);
+    if (ok && header.version >= 3) {
+        uint8_t drive_stale;
+        ok = read_value(file, inputs.v_stale) && read_value(file, inputs.h_stale);
+        ok = ok && read_value(file, inputs.imu_stale) && read_value(file, drive_stale);
+        inputs.drive_stale = drive_stale;
+    }
+    if (ok && header.version >= 6) {
+        uint8_t drive_repeat;
+        ok = read_value(file, inputs.v_repeat) && read_value(file, inputs.h_repeat) && read_value(file, drive_repeat);
+        inputs.drive_repeat = drive_repeat;
+    }
+    // Fresh readings are taken at the tick's timestamp, and only fresh
+    // readings' sample times are used.
+    inputs.v_sample_us.fill(inputs.timestamp_us);
+    inputs.h_sample_us.fill(inputs.timestamp_us);
+    inputs.imu_sample_us.fill(inputs.timestamp_us);
+    inputs.drive_sample_us = inputs.timestamp_us;
+    return ok;
+}
+
+static bool read_measurement(std::FILE* file, PoseMeasurement& measurement) {
+    uint8_t present;
+    bool ok = read_value(file, measurement.timestamp_us) && read_value(file, present);
+    std::optional<double>* components[] = {&measurement.x, &measurement.y, &measurement.heading};
+    for (std::size_t i = 0; ok && i < 3; i++) {
+        double value;
+        if (!(present >> i & 1)) continue;
+        ok = read_value(file, value);
+        *components[i] = value;
+    }
+    for (double* value : {&measurement.variance_xy, &measurement.variance_heading, &measurement.gate}) {
+        ok = ok && read_value(file, *value);
+    }
+    return ok;
+}
+
+bool read_log_record(std::FILE* file, const OdometryLogHeader& header, OdometryLogRecord& record) {
+    record = {};
+    if (header.version < 4) return read_inputs(file, header, record.inputs);
+    if (!read_value(file, record.event)) return false;
+    switch (record.event) {
+        case OdometryLogEvent::Inputs:
+            return read_inputs(file, header, record.inputs);
+        case OdometryLogEvent::Reset: {
+            double x, y, heading;
+            const bool ok = read_value(file, x) && read_value(file, y) && read_value(file, heading);
+            record.pose = Pose(x, y, heading);
+            return ok;
+        }
+        case OdometryLogEvent::Measurement:
+            return read_measurement(file, record.measurement);
+        case OdometryLogEvent::ImuDrift: {
+            // v4 also stored an unused gyro bias between the two.
+            double gyro_bias;
+            return read_value(file, record.imu) && read_value(file, record.drift.rate) &&
+                   (header.version >= 5 || read_value(file, gyro_bias)) && read_value(file, record.drift.learned_s);
+        }
+        case OdometryLogEvent::Dropped:
+            return read_value(file, record.dropped);
+    }
+    return false;
+}
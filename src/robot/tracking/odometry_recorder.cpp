@@ -0,0 +1,59 @@
+#include "odometry_recorder.h"
+#include "pros/rtos.hpp"
+
+static constexpr uint32_t WRITER_PERIOD_MS = 20;
+
+bool OdometryRecorder::start(Odometry* odometry, const char* path) {
+    if (running.load()) return false;
+    file = std::fopen(path, "wb");
+    if (!file) return false;
+
+    header = odometry->get_log_header();
+    if (!write_log_header(file, header)) {
+        std::fclose(file);
+        file = nullptr;
+        return false;
+    }
+
+    OdometryRecorder::odometry = odometry;
+    running.store(true);
+    task.emplace([this] { writer_loop(); }, TASK_PRIORITY_MIN + 1, TASK_STACK_DEPTH_DEFAULT, "Odometry Recorder");
+    odometry->set_recorder(this);
+    return true;
+}
+
+void OdometryRecorder::stop() {
+    if (!running.load()) return;
+    // Once detached no record() is in flight, so the writer drains all of
+    // them before it exits.
+    odometry->set_recorder(nullptr);
+    running.store(false);
+    task->join();
+    task.reset();
+}
+
+uint32_t OdometryRecorder::get_dropped() const {
+    return dropped.load(std::memory_order_relaxed);
+}
+
+// Notes records lost since the last call, so replay can refuse the log.
+void OdometryRecorder::write_dropped() {
+    const uint32_t total = dropped.load(std::memory_order_relaxed);
+    if (total == dropped_written) return;
+    OdometryLogRecord record;
+    record.event = OdometryLogEvent::Dropped;
+    record.dropped = total - dropped_written;
+    dropped_written = total;
+    write_log_record(file, header, record);
+}
+
+void OdometryRecorder::writer_loop() {
+    while (running.load() || !queue.empty()) {
+        while (auto record = queue.pop()) write_log_record(file, header, record.value());
+        write_dropped();
+        pros::delay(WRITER_PERIOD_MS);
+    }
+    write_dropped();
+    std::fclose(file);
+    file = nullptr;
+}
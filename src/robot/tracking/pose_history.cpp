@@ -0,0 +1,89 @@
+#include "pose_history.h"
+#include "utils/angle.h"
+#include "utils/trig.h"
+#include <cmath>
+
+void PoseHistory::push(uint64_t timestamp_us, const Vec3& state, const Mat3& covariance) {
+    if (count < capacity) {
+        count++;
+    } else {
+        start = (start + 1) % capacity;
+    }
+    get(count - 1) = {timestamp_us, state, covariance};
+}
+
+const PoseSample& PoseHistory::get(std::size_t index) const {
+    return samples[(start + index) % capacity];
+}
+
+PoseSample& PoseHistory::get(std::size_t index) {
+    return samples[(start + index) % capacity];
+}
+
+std::size_t PoseHistory::lower_bound(uint64_t timestamp_us) const {
+    std::size_t low = 0, high = count;
+    while (low < high) {
+        std::size_t mid = (low + high) / 2;
+        if (get(mid).timestamp_us < timestamp_us) low = mid + 1;
+        else high = mid;
+    }
+    return low;
+}
+
+std::optional<PoseSample> PoseHistory::at(uint64_t timestamp_us) const {
+    if (count == 0 || timestamp_us < get(0).timestamp_us) return std::nullopt;
+
+    std::size_t index = lower_bound(timestamp_us);
+    if (index == count) return get(count - 1);
+
+    const PoseSample& after = get(index);
+    if (after.timestamp_us == timestamp_us || index == 0) return after;
+    const PoseSample& before = get(index - 1);
+
+    double t = static_cast<double>(timestamp_us - before.timestamp_us) / (after.timestamp_us - before.timestamp_us);
+    PoseSample result = {timestamp_us, {}, before.covariance + t * (after.covariance - before.covariance)};
+    result.state[0] = before.state[0] + t * (after.state[0] - before.state[0]);
+    result.state[1] = before.state[1] + t * (after.state[1] - before.state[1]);
+    result.state[2] = wrap_angle(before.state[2] + t * wrap_angle(after.state[2] - before.state[2]));
+    return result;
+}
+
+void PoseHistory::apply_correction(uint64_t timestamp_us, const Vec3& before, const Vec3& after, const Mat3& covariance_reduction) {
+    for (std::size_t i = lower_bound(timestamp_us); i < count; i++) {
+        PoseSample& sample = get(i);
+        sample.state = transfer_pose(sample.state, before, after);
+        sample.covariance = sample.covariance - covariance_reduction;
+    }
+}
+
+std::optional<PoseSample> PoseHistory::newest() const {
+    if (count == 0) return std::nullopt;
+    return get(count - 1);
+}
+
+std::size_t PoseHistory::size() const {
+    return count;
+}
+
+void PoseHistory::clear() {
+    start = 0;
+    count = 0;
+}
+
+Vec3 transfer_pose(const Vec3& pose, const Vec3& before, const Vec3& after) {
+    // Offset of `pose` in the frame of `before`...
+    double dx = pose[0] - before[0];
+    double dy = pose[1] - before[1];
+    double s, c;
+    Trig::sincos(before[2], s, c);
+    double local_x = c * dx + s * dy;
+    double local_y = -s * dx + c * dy;
+
+    // ...re-applied in the frame of `after`.
+    Trig::sincos(after[2], s, c);
+    return {
+        after[0] + c * local_x - s * local_y,
+        after[1] + s * local_x + c * local_y,
+        wrap_angle(after[2] + wrap_angle(pose[2] - before[2]))
+    };
+}
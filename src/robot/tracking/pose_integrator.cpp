@@ -0,0 +1,28 @@
+#include "pose_integrator.h"
+#include "utils/trig.h"
+#include <cmath>
+
+// Below this heading change the series forms of sin(t)/t and (1 - cos(t))/t
+// are exact to double precision.
+static constexpr double SERIES_THRESHOLD = 1e-3;
+
+Vec3 integrate_exponential(const Vec3& pose, const Twist& twist) {
+    const double t = twist.dtheta;
+    double a, b;
+    if (std::abs(t) < SERIES_THRESHOLD) {
+        const double t2 = t * t;
+        a = 1 - t2 / 6 * (1 - t2 / 20);
+        b = t / 2 * (1 - t2 / 12);
+    } else {
+        double s, c;
+        Trig::sincos(t, s, c);
+        a = s / t;
+        b = (1 - c) / t;
+    }
+    const double local_x = a * twist.dx - b * twist.dy;
+    const double local_y = b * twist.dx + a * twist.dy;
+
+    double s, c;
+    Trig::sincos(pose[2], s, c);
+    return {pose[0] + c * local_x - s * local_y, pose[1] + s * local_x + c * local_y, pose[2] + t};
+}
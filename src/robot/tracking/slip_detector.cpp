@@ -0,0 +1,24 @@
+#include "slip_detector.h"
+#include <algorithm>
+#include <cmath>
+
+static double side_ratio(double actual, double expected, double floor) {
+    return std::min(std::abs(actual - expected) / std::max(std::abs(actual), floor), 1.0);
+}
+
+SlipEstimate SlipDetector::update(double left, double right, double expected_left, double expected_right,
+    double accel, double dt, const SlipConfig& config) {
+    const double floor = std::max(config.min_speed * dt, 1e-6);
+    SlipEstimate estimate = {side_ratio(left, expected_left, floor), side_ratio(right, expected_right, floor), 0, false};
+
+    ratio += (std::max(estimate.left, estimate.right) - ratio) / std::max(config.window, 1.0);
+    estimate.ratio = ratio;
+
+    const bool driving = std::max(std::abs(left), std::abs(right)) >= floor;
+    estimate.slipping = driving && accel < config.accel_gate && ratio > config.threshold;
+    return estimate;
+}
+
+void SlipDetector::reset() {
+    ratio = 0;
+}
@@ -2,23 +2,63 @@
 #include "pros/rotation.hpp"
 #include <cmath>
 
+static constexpr double TICKS_PER_REVOLUTION = 36000.0;
+
 TrackingWheel::TrackingWheel(pros::Rotation* encoder, float diameter, double offset)
     : encoder(encoder), 
     diameter(diameter), 
-    offset(offset), 
-    last_total(get_distance_total()) {}
+    offset(offset) {}
+
+void TrackingWheel::set_position(int32_t position) {
+    if (!primed) {
+        resync(position);
+        return;
+    }
+    total_ticks += peek_delta(position);
+    last_position = position;
+}
+
+void TrackingWheel::resync(int32_t position) {
+    primed = true;
+    last_position = position;
+}
+
+int32_t TrackingWheel::peek_delta(int32_t position) const {
+    if (!primed) return 0;
+    // Unsigned subtraction keeps the delta exact across int32 rollover.
+    return static_cast<int32_t>(static_cast<uint32_t>(position) - static_cast<uint32_t>(last_position));
+}
+
+double TrackingWheel::ticks_to_distance(int64_t ticks) const {
+    return static_cast<double>(ticks) / TICKS_PER_REVOLUTION * M_PI * diameter;
+}
 
 double TrackingWheel::get_distance_total() {
-    return encoder->get_angle() / 360.0f * M_PI * diameter;
+    return ticks_to_distance(total_ticks);
 }
 
 double TrackingWheel::get_distance_delta() {
-    const double total = this->get_distance_total();
-    const double delta = total - last_total;
-    last_total = total;
-    return delta;
+    const int64_t delta = total_ticks - last_total_ticks;
+    last_total_ticks = total_ticks;
+    return ticks_to_distance(delta);
 }
 
 double TrackingWheel::get_offset() {
     return offset;
-}
\ No newline at end of file
+}
+
+double TrackingWheel::get_diameter() {
+    return diameter;
+}
+
+void TrackingWheel::set_offset(double offset) {
+    TrackingWheel::offset = offset;
+}
+
+void TrackingWheel::set_diameter(double diameter) {
+    TrackingWheel::diameter = diameter;
+}
+
+pros::Rotation* TrackingWheel::get_encoder() {
+    return encoder;
+}
@@ -0,0 +1,223 @@
+#include "wheel_calibration.h"
+#include "pros/error.h"
+#include "pros/imu.hpp"
+#include "pros/rotation.hpp"
+#include "pros/rtos.hpp"
+#include "robot/chassis.h"
+#include "utils/angle.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+
+static constexpr uint32_t SAMPLE_PERIOD_MS = 10;
+static constexpr uint32_t SETTLE_MS = 300;
+static constexpr uint32_t SPIN_TIMEOUT_MS_PER_TURN = 8000;
+
+static int32_t tick_delta(int32_t position, int32_t reference) {
+    return static_cast<int32_t>(static_cast<uint32_t>(position) - static_cast<uint32_t>(reference));
+}
+
+WheelCalibration::WheelCalibration(pros::IMU* imu, std::vector<TrackingWheel*> v_wheels, std::vector<TrackingWheel*> h_wheels)
+    : imu(imu) {
+    for (auto* wheel : v_wheels) {
+        if (wheel_count == max_wheels) break;
+        axes[wheel_count] = TrackingAxis::Vertical;
+        wheels[wheel_count++] = wheel;
+    }
+    v_wheel_count = wheel_count;
+    for (auto* wheel : h_wheels) {
+        if (wheel_count == max_wheels) break;
+        axes[wheel_count] = TrackingAxis::Horizontal;
+        wheels[wheel_count++] = wheel;
+    }
+    for (std::size_t i = 0; i < wheel_count; i++) fits[i] = {wheels[i]->get_diameter(), wheels[i]->get_offset(), 0};
+
+    spin_samples.reserve(max_spin_samples);
+    straight_runs.reserve(max_straight_runs);
+}
+
+bool WheelCalibration::read_ticks(std::array<int32_t, max_wheels>& ticks) const {
+    for (std::size_t i = 0; i < wheel_count; i++) {
+        ticks[i] = wheels[i]->get_encoder()->get_position();
+        if (ticks[i] == PROS_ERR) return false;
+    }
+    return true;
+}
+
+bool WheelCalibration::run_spin(Chassis& chassis, double turns, float power) {
+    const double start = imu->get_rotation();
+    if (!std::isfinite(start)) return false;
+
+    const double target = std::abs(turns) * 360.0;
+    const float direction = turns < 0 ? -1.0f : 1.0f;
+    const uint32_t timeout_ms = static_cast<uint32_t>(std::abs(turns) * SPIN_TIMEOUT_MS_PER_TURN);
+    const uint32_t start_ms = pros::millis();
+    spin_starts.push_back(spin_samples.size());
+
+    bool ok = true;
+    uint32_t stop_ms = 0;
+    uint32_t wake_time = pros::millis();
+    while (spin_samples.size() < max_spin_samples) {
+        SpinSample sample = {imu->get_rotation(), {}};
+        if (!std::isfinite(sample.rotation)) {
+            ok = false;
+            break;
+        }
+        if (read_ticks(sample.ticks)) spin_samples.push_back(sample);
+
+        const uint32_t now = pros::millis();
+        if (!stop_ms && (std::abs(sample.rotation - start) >= target || now - start_ms > timeout_ms)) {
+            ok = std::abs(sample.rotation - start) >= target;
+            stop_ms = now;
+        }
+        if (stop_ms && now - stop_ms >= SETTLE_MS) break;
+
+        const float spin = stop_ms ? 0.0f : direction * power;
+        chassis.tank(spin, -spin);
+        pros::Task::delay_until(&wake_time, SAMPLE_PERIOD_MS);
+    }
+
+    chassis.tank(0, 0);
+    return ok;
+}
+
+bool WheelCalibration::begin_straight() {
+    straight_started = read_ticks(straight_start);
+    return straight_started;
+}
+
+bool WheelCalibration::end_straight(TrackingAxis axis, double distance) {
+    StraightRun run = {axis, std::abs(distance), {}};
+    if (!straight_started || straight_runs.size() == max_straight_runs || !read_ticks(run.ticks)) return false;
+    straight_started = false;
+    for (std::size_t i = 0; i < wheel_count; i++) run.ticks[i] = tick_delta(run.ticks[i], straight_start[i]);
+    straight_runs.push_back(run);
+    return true;
+}
+
+bool WheelCalibration::fit() {
+    // Diameter: measured = scale * nominal over every run on the wheel's axis,
+    // where nominal is the distance at the current diameter.
+    for (std::size_t i = 0; i < wheel_count; i++) {
+        double ln = 0, nn = 0;
+        for (const auto& run : straight_runs) {
+            if (run.axis != axes[i]) continue;
+            double nominal = std::abs(wheels[i]->ticks_to_distance(run.ticks[i]));
+            ln += run.distance * nominal;
+            nn += nominal * nominal;
+        }
+        if (nn > 0) wheels[i]->set_diameter(wheels[i]->get_diameter() * ln / nn);
+        fits[i].diameter = wheels[i]->get_diameter();
+    }
+
+    // Offset: travel = -offset * heading change (see TrackingWheel), through
+    // the origin of each spin.
+    for (std::size_t i = 0; i < wheel_count; i++) {
+        double td = 0, tt = 0;
+        for (std::size_t run = 0; run < spin_starts.size(); run++) {
+            const std::size_t begin = spin_starts[run];
+            const std::size_t end = run + 1 < spin_starts.size() ? spin_starts[run + 1] : spin_samples.size();
+            for (std::size_t k = begin; k < end; k++) {
+                double theta = to_radians(spin_samples[k].rotation - spin_samples[begin].rotation);
+                double distance = wheels[i]->ticks_to_distance(tick_delta(spin_samples[k].ticks[i], spin_samples[begin].ticks[i]));
+                td += theta * distance;
+                tt += theta * theta;
+            }
+        }
+        if (tt <= 0) continue;
+        const double offset = -td / tt;
+
+        double sum_squares = 0;
+        std::size_t count = 0;
+        for (std::size_t run = 0; run < spin_starts.size(); run++) {
+            const std::size_t begin = spin_starts[run];
+            const std::size_t end = run + 1 < spin_starts.size() ? spin_starts[run + 1] : spin_samples.size();
+            for (std::size_t k = begin; k < end; k++, count++) {
+                double theta = to_radians(spin_samples[k].rotation - spin_samples[begin].rotation);
+                double distance = wheels[i]->ticks_to_distance(tick_delta(spin_samples[k].ticks[i], spin_samples[begin].ticks[i]));
+                sum_squares += (distance + offset * theta) * (distance + offset * theta);
+            }
+        }
+        wheels[i]->set_offset(offset);
+        fits[i].offset = offset;
+        fits[i].rms_error = std::sqrt(sum_squares / count);
+    }
+    return !straight_runs.empty() || !spin_starts.empty();
+}
+
+std::size_t WheelCalibration::wheel_index(TrackingAxis axis, std::size_t index) const {
+    return axis == TrackingAxis::Vertical ? index : v_wheel_count + index;
+}
+
+WheelFit WheelCalibration::get_fit(TrackingAxis axis, std::size_t index) const {
+    const std::size_t i = wheel_index(axis, index);
+    return i < wheel_count && axes[i] == axis ? fits[i] : WheelFit{};
+}
+
+bool WheelCalibration::save(const char* path) const {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    bool ok = true;
+    for (std::size_t i = 0; i < wheel_count; i++) {
+        const char axis = axes[i] == TrackingAxis::Vertical ? 'v' : 'h';
+        const std::size_t index = axes[i] == TrackingAxis::Vertical ? i : i - v_wheel_count;
+        ok = ok && std::fprintf(file, "%c %zu %.9g %.9g\n", axis, index, fits[i].diameter, fits[i].offset) > 0;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool WheelCalibration::write_samples(const char* path) const {
+    std::FILE* file = std::fopen(path, "w");
+    if (!file) return false;
+    bool ok = true;
+    for (std::size_t run = 0; run < spin_starts.size(); run++) {
+        const std::size_t end = run + 1 < spin_starts.size() ? spin_starts[run + 1] : spin_samples.size();
+        for (std::size_t k = spin_starts[run]; k < end; k++) {
+            ok = ok && std::fprintf(file, "spin,%zu,%.6f", run, spin_samples[k].rotation) > 0;
+            for (std::size_t i = 0; i < wheel_count; i++) ok = ok && std::fprintf(file, ",%ld", static_cast<long>(spin_samples[k].ticks[i])) > 0;
+            ok = ok && std::fputc('\n', file) != EOF;
+        }
+    }
+    for (std::size_t run = 0; run < straight_runs.size(); run++) {
+        const auto& straight = straight_runs[run];
+        const char axis = straight.axis == TrackingAxis::Vertical ? 'v' : 'h';
+        ok = ok && std::fprintf(file, "straight_%c,%zu,%.6f", axis, run, straight.distance) > 0;
+        for (std::size_t i = 0; i < wheel_count; i++) ok = ok && std::fprintf(file, ",%ld", static_cast<long>(straight.ticks[i])) > 0;
+        ok = ok && std::fputc('\n', file) != EOF;
+    }
+    return std::fclose(file) == 0 && ok;
+}
+
+bool load_wheel_calibration(const char* path, std::vector<TrackingWheel*> v_wheels, std::vector<TrackingWheel*> h_wheels) {
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) return false;
+
+    // Nothing is applied until the whole file has parsed, so a bad line
+    // cannot leave some wheels on old geometry and some on new.
+    struct Entry {
+        TrackingWheel* wheel;
+        double diameter;
+        double offset;
+    };
+    std::vector<Entry> entries;
+    entries.reserve(v_wheels.size() + h_wheels.size());
+
+    char axis;
+    std::size_t index;
+    double diameter, offset;
+    bool ok = true;
+    int fields;
+    while (ok && (fields = std::fscanf(file, " %c %zu %lf %lf", &axis, &index, &diameter, &offset)) == 4) {
+        const auto& wheels = axis == 'v' ? v_wheels : h_wheels;
+        ok = (axis == 'v' || axis == 'h') && index < wheels.size() && diameter > 0 && std::isfinite(offset);
+        if (ok) entries.push_back({wheels[index], diameter, offset});
+    }
+    std::fclose(file);
+    if (!ok || fields != EOF) return false;
+
+    for (const Entry& entry : entries) {
+        entry.wheel->set_diameter(entry.diameter);
+        entry.wheel->set_offset(entry.offset);
+    }
+    return true;
+}
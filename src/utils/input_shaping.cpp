@@ -0,0 +1,37 @@
+#include "input_shaping.h"
+#include <algorithm>
+#include <cmath>
+
+float shape(const CurveTable& curve, float value) {
+    const float magnitude = std::min(std::abs(value), JOYSTICK_MAX);
+    const std::size_t index = static_cast<std::size_t>(magnitude);
+    float output = curve[index];
+    if (index + 1 < curve.size()) output += (curve[index + 1] - output) * (magnitude - index);
+    return value < 0 ? -output : output;
+}
+
+float scaled_deadzone(float value, float deadzone) {
+    const float magnitude = std::min(std::abs(value), JOYSTICK_MAX);
+    if (magnitude <= deadzone || deadzone >= JOYSTICK_MAX) return 0.0f;
+    const float scaled = (magnitude - deadzone) / (JOYSTICK_MAX - deadzone) * JOYSTICK_MAX;
+    return value < 0 ? -scaled : scaled;
+}
+
+void radial_deadzone(float& x, float& y, float deadzone) {
+    const float magnitude = std::hypot(x, y);
+    const float scaled = scaled_deadzone(magnitude, deadzone);
+    if (scaled == 0.0f) {
+        x = 0.0f;
+        y = 0.0f;
+        return;
+    }
+    x *= scaled / magnitude;
+    y *= scaled / magnitude;
+}
+
+void desaturate(float& left, float& right) {
+    const float largest = std::max(std::abs(left), std::abs(right));
+    if (largest <= JOYSTICK_MAX) return;
+    left *= JOYSTICK_MAX / largest;
+    right *= JOYSTICK_MAX / largest;
+}
@@ -1,4 +1,7 @@
 #include "pose.h"
 
+Pose::Pose()
+    : x(0), y(0), heading(0) {}
+
 Pose::Pose(float x, float y, float heading)
     : x(x), y(y), heading(heading) {}
\ No newline at end of file
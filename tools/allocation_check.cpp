@@ -0,0 +1,111 @@
+// Checks that Odometry::update() never touches the heap. Global operator
+// new is replaced with a counting version, and each configuration runs a
+// few thousand synthetic ticks with every optional path switched on: two
+// vertical and two horizontal tracking wheels, an IMU, drive encoders, slip
+// detection, noise adaptation and a submitted measurement every tenth tick,
+// under both the scalar filter and the EKF. Construction and configuration
+// may allocate; from the first update() on, nothing may.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/allocation_check.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/pose_history.cpp
+//       src/robot/tracking/imu_drift.cpp src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o allocation_check
+//
+// Usage:
+//   allocation_check
+//
+// Exits non-zero if any configuration allocates during update().
+#include "drive_encoders.h"
+#include "odometry.h"
+#include "tracking_wheel.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+
+static constexpr double WHEEL_DIAMETER = 2.0;
+static constexpr double DRIVE_WHEEL_DIAMETER = 3.25;
+static constexpr double TRACK_WIDTH = 12.0;
+static constexpr std::size_t TICKS = 5000;
+
+static std::size_t allocations = 0;
+
+static void* counted_allocate(std::size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size ? size : 1)) return memory;
+    throw std::bad_alloc();
+}
+
+void* operator new(std::size_t size) { return counted_allocate(size); }
+void* operator new[](std::size_t size) { return counted_allocate(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept {
+    allocations++;
+    return std::malloc(size ? size : 1);
+}
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+static int32_t wheel_ticks(double distance) {
+    return static_cast<int32_t>(std::lround(distance / (M_PI * WHEEL_DIAMETER) * 36000.0));
+}
+
+// A robot driving a gentle arc at 30 inches/second; every sensor is fresh
+// on every tick.
+static Odometry::Inputs synthesize(std::size_t tick) {
+    const double t = tick * 0.01, travel = 30.0 * t, theta = 0.5 * t;
+    Odometry::Inputs inputs = {};
+    inputs.timestamp_us = static_cast<uint64_t>(tick) * 10'000;
+    inputs.v_ticks = {wheel_ticks(travel - 1.5 * theta), wheel_ticks(travel + 1.5 * theta)};
+    inputs.h_ticks = {wheel_ticks(-4.0 * theta), wheel_ticks(1.0 * theta)};
+    inputs.imu_headings[0] = std::fmod(theta * 180 / M_PI, 360.0);
+    const double side_degrees = 360.0 / (M_PI * DRIVE_WHEEL_DIAMETER);
+    inputs.drive_degrees = {(travel + TRACK_WIDTH / 2 * theta) * side_degrees, (travel - TRACK_WIDTH / 2 * theta) * side_degrees};
+    inputs.v_sample_us.fill(inputs.timestamp_us);
+    inputs.h_sample_us.fill(inputs.timestamp_us);
+    inputs.imu_sample_us.fill(inputs.timestamp_us);
+    inputs.drive_sample_us = inputs.timestamp_us;
+    return inputs;
+}
+
+static bool run(const char* name, OdometryFilter filter) {
+    TrackingWheel v_wheels[2] = {{nullptr, WHEEL_DIAMETER, 1.5}, {nullptr, WHEEL_DIAMETER, -1.5}};
+    TrackingWheel h_wheels[2] = {{nullptr, WHEEL_DIAMETER, 4.0}, {nullptr, WHEEL_DIAMETER, -1.0}};
+    DriveEncoders drive_encoders(nullptr, nullptr, {DRIVE_WHEEL_DIAMETER, 1.0, TRACK_WIDTH});
+    Odometry odometry({nullptr}, {&v_wheels[0], &v_wheels[1]}, {&h_wheels[0], &h_wheels[1]}, 1e-3, 1e-3, 1e-3, 1e-3,
+                      1e-4, 1e-6);
+    odometry.set_filter(filter);
+    odometry.set_drive_encoders(&drive_encoders);
+    odometry.set_noise_adaptation({true});
+    odometry.set_slip_detection({true});
+    Pose pose(0, 0, 0);
+    odometry.reset(pose);
+
+    const std::size_t before = allocations;
+    for (std::size_t tick = 1; tick <= TICKS; tick++) {
+        if (tick % 10 == 0) {
+            odometry.submit_measurement({(tick - 5) * 10'000, pose.x, pose.y, pose.heading, 0.25, 1e-4});
+        }
+        odometry.update(pose, synthesize(tick));
+    }
+    const std::size_t count = allocations - before;
+    std::printf("%-8s %8zu %12zu  %s\n", name, TICKS, count, count == 0 ? "ok" : "FAIL");
+    return count == 0;
+}
+
+int main() {
+    std::printf("%-8s %8s %12s\n", "filter", "updates", "allocations");
+    bool ok = run("scalar", OdometryFilter::Scalar);
+    ok = run("ekf", OdometryFilter::Ekf) && ok;
+    return ok ? 0 : 1;
+}
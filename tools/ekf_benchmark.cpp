@@ -0,0 +1,131 @@
+// Per-update cost of the Odometry EKF against the scalar filter. Each case
+// runs the same synthetic drive (a weaving arc at 40 inches/second, 10 ms
+// ticks, every sensor fresh) through Odometry::update() and reports the
+// mean, 99th percentile and worst host time per call. Cases cover the
+// sensor layouts the filter supports, noise adaptation, and absolute
+// measurements submitted every tick with 50 ms of latency, which makes each
+// update replay that much pose history. Only useful for comparing the cases
+// with each other, and the worst case on a desktop host mostly measures its
+// scheduler; on the robot the odometry task's OdometryStats give the real
+// per-tick figure.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/ekf_benchmark.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/pose_history.cpp
+//       src/robot/tracking/imu_drift.cpp src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o ekf_benchmark
+//
+// Usage:
+//   ekf_benchmark
+#include "odometry.h"
+#include "tracking_wheel.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static constexpr double WHEEL_DIAMETER = 2.0;
+static constexpr double V_WHEEL_OFFSETS[2] = {1.5, -1.5};
+static constexpr double H_WHEEL_OFFSETS[2] = {4.0, -1.0};
+static constexpr uint64_t PERIOD_US = 10'000;
+static constexpr uint64_t MEASUREMENT_LATENCY_US = 50'000;
+static constexpr std::size_t WARMUP_TICKS = 500;
+static constexpr std::size_t TIMED_TICKS = 100'000;
+
+struct Case {
+    const char* name;
+    std::size_t v_wheels;
+    std::size_t h_wheels;
+    bool imu;
+    bool adaptation;
+    bool measurements;
+};
+
+static const Case CASES[] = {
+    {"1v1h+imu", 1, 1, true, false, false},
+    {"2v2h+imu", 2, 2, true, false, false},
+    {"1v2h", 1, 2, false, false, false},
+    {"2v2h+imu adapt", 2, 2, true, true, false},
+    {"2v2h+imu fuse", 2, 2, true, false, true},
+};
+
+static int32_t wheel_ticks(double distance) {
+    return static_cast<int32_t>(std::lround(distance / (M_PI * WHEEL_DIAMETER) * 36000.0));
+}
+
+// Body-frame travel and heading after tick `tick` of the synthetic drive.
+static Odometry::Inputs synthesize(std::size_t tick) {
+    const double t = tick * PERIOD_US / 1e6;
+    const double travel = 40.0 * t, strafe = 2.0 * std::sin(0.7 * t), theta = 0.8 * t + 0.5 * std::sin(1.1 * t);
+    Odometry::Inputs inputs = {};
+    inputs.timestamp_us = tick * PERIOD_US;
+    for (std::size_t i = 0; i < 2; i++) {
+        inputs.v_ticks[i] = wheel_ticks(travel - V_WHEEL_OFFSETS[i] * theta);
+        inputs.h_ticks[i] = wheel_ticks(strafe - H_WHEEL_OFFSETS[i] * theta);
+    }
+    const double degrees = std::fmod(theta * 180 / M_PI, 360.0);
+    inputs.imu_headings[0] = degrees < 0 ? degrees + 360.0 : degrees;
+    inputs.v_sample_us.fill(inputs.timestamp_us);
+    inputs.h_sample_us.fill(inputs.timestamp_us);
+    inputs.imu_sample_us.fill(inputs.timestamp_us);
+    return inputs;
+}
+
+struct Cost {
+    double mean;
+    double p99;
+    double worst;
+};
+
+static Cost run(const Case& config, OdometryFilter filter) {
+    TrackingWheel v_wheels[2] = {{nullptr, WHEEL_DIAMETER, V_WHEEL_OFFSETS[0]}, {nullptr, WHEEL_DIAMETER, V_WHEEL_OFFSETS[1]}};
+    TrackingWheel h_wheels[2] = {{nullptr, WHEEL_DIAMETER, H_WHEEL_OFFSETS[0]}, {nullptr, WHEEL_DIAMETER, H_WHEEL_OFFSETS[1]}};
+    std::vector<TrackingWheel*> v, h;
+    for (std::size_t i = 0; i < config.v_wheels; i++) v.push_back(&v_wheels[i]);
+    for (std::size_t i = 0; i < config.h_wheels; i++) h.push_back(&h_wheels[i]);
+    std::vector<pros::IMU*> imus;
+    if (config.imu) imus.push_back(nullptr);
+    Odometry odometry(imus, v, h, 1e-3, 1e-3, 1e-3, 1e-3, 1e-4, 1e-6);
+    odometry.set_filter(filter);
+    odometry.set_noise_adaptation({config.adaptation});
+    Pose pose(0, 0, 0);
+    odometry.reset(pose);
+
+    std::vector<double> samples;
+    samples.reserve(TIMED_TICKS);
+    for (std::size_t tick = 1; tick <= WARMUP_TICKS + TIMED_TICKS; tick++) {
+        const Odometry::Inputs inputs = synthesize(tick);
+        if (config.measurements && tick * PERIOD_US > MEASUREMENT_LATENCY_US) {
+            odometry.submit_measurement({inputs.timestamp_us - MEASUREMENT_LATENCY_US, pose.x, pose.y, std::nullopt, 1.0, 0});
+        }
+        const auto start = std::chrono::steady_clock::now();
+        odometry.update(pose, inputs);
+        const auto end = std::chrono::steady_clock::now();
+        if (tick > WARMUP_TICKS) samples.push_back(std::chrono::duration<double, std::nano>(end - start).count());
+    }
+
+    Cost cost = {};
+    for (double sample : samples) cost.mean += sample;
+    cost.mean /= samples.size();
+    std::sort(samples.begin(), samples.end());
+    cost.p99 = samples[samples.size() * 99 / 100];
+    cost.worst = samples.back();
+    return cost;
+}
+
+int main() {
+    std::printf("%-16s %-7s %10s %10s %10s\n", "case", "filter", "mean_ns", "p99_ns", "worst_ns");
+    for (const Case& config : CASES) {
+        for (OdometryFilter filter : {OdometryFilter::Scalar, OdometryFilter::Ekf}) {
+            const Cost cost = run(config, filter);
+            std::printf("%-16s %-7s %10.1f %10.1f %10.1f\n", config.name, filter == OdometryFilter::Ekf ? "ekf" : "scalar",
+                        cost.mean, cost.p99, cost.worst);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,266 @@
+// Compares the Odometry pose integrators (see pose_integrator.h) across tick
+// periods. Synthetic paths are integrated finely for ground truth and
+// sampled into quantized Odometry::Inputs at 5, 10 and 20 ms, on two rigs:
+// one vertical and one horizontal wheel with an IMU, and one vertical and
+// two horizontal wheels with no IMU, so heading comes from the wheel pair
+// alone. Position and heading error are both reported; a recorded
+// log (see odometry_log.h) is replayed at 1x, 2x and 4x its recorded
+// period against its own full-rate exponential replay. Every run uses the
+// EKF, so the translation is not rescaled by the scalar filter's gains.
+// Cost is host time per Odometry::update(), useful only for comparing the
+// integrators with each other.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/integrator_benchmark.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/odometry_log.cpp
+//       src/robot/tracking/pose_history.cpp src/robot/tracking/imu_drift.cpp
+//       src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o integrator_benchmark
+//
+// Usage:
+//   integrator_benchmark [log]
+//
+// Exits non-zero if a synthetic run ends more than MAX_POSITION_ERROR or
+// MAX_HEADING_ERROR off.
+#include "odometry.h"
+#include "odometry_log.h"
+#include "pose_integrator.h"
+#include "tracking_wheel.h"
+#include "utils/angle.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static constexpr double WHEEL_DIAMETER = 2.0;
+static constexpr double V_WHEEL_OFFSET = 1.5;
+static constexpr double H_WHEEL_OFFSETS[2] = {4.0, -1.0};
+static constexpr double DURATION_S = 20.0;
+static constexpr double TRUTH_STEP_S = 50e-6;
+static constexpr double MAX_POSITION_ERROR = 0.5;      // inches
+static constexpr double MAX_HEADING_ERROR = M_PI / 180; // radians
+
+struct Path {
+    const char* name;
+    double (*vx)(double t);
+    double (*vy)(double t);
+    double (*omega)(double t);
+};
+
+static const Path PATHS[] = {
+    {"arc", [](double) { return 40.0; }, [](double) { return 0.0; }, [](double) { return 1.5; }},
+    {"s-curve", [](double) { return 50.0; }, [](double) { return 0.0; },
+        [](double t) { return 3.0 * std::sin(M_PI * t); }},
+    {"fast-turn", [](double t) { return 30.0 + 20.0 * std::sin(t); }, [](double) { return 0.0; },
+        [](double) { return 6.0; }},
+    {"strafe-turn", [](double t) { return 30.0 * std::cos(0.7 * t); }, [](double) { return 20.0; },
+        [](double t) { return 2.0 * std::sin(1.3 * t); }},
+    {"spin", [](double) { return 0.0; }, [](double) { return 0.0; }, [](double) { return 2.0; }},
+};
+
+struct Rig {
+    const char* name;
+    std::size_t h_wheels;
+    bool imu;
+};
+
+static const Rig RIGS[] = {
+    {"1v1h+imu", 1, true},
+    {"1v2h", 2, false},
+};
+
+// Body-frame arc lengths and heading since the start, plus the true pose.
+struct TruthSample {
+    double sx;
+    double sy;
+    double theta;
+    Vec3 pose;
+};
+
+static std::vector<TruthSample> integrate_truth(const Path& path) {
+    const std::size_t steps = static_cast<std::size_t>(DURATION_S / TRUTH_STEP_S + 0.5);
+    std::vector<TruthSample> truth;
+    truth.reserve(steps + 1);
+    TruthSample sample = {0, 0, 0, {0, 0, 0}};
+    truth.push_back(sample);
+    for (std::size_t i = 0; i < steps; i++) {
+        const double mid = (i + 0.5) * TRUTH_STEP_S;
+        const Twist twist = {path.vx(mid) * TRUTH_STEP_S, path.vy(mid) * TRUTH_STEP_S, path.omega(mid) * TRUTH_STEP_S};
+        sample.sx += twist.dx;
+        sample.sy += twist.dy;
+        sample.theta += twist.dtheta;
+        sample.pose = integrate_exponential(sample.pose, twist);
+        truth.push_back(sample);
+    }
+    return truth;
+}
+
+// Wheel travel follows the TrackingWheel convention: turning by theta moves a
+// wheel -offset * theta on top of the tracking centre's travel.
+static int32_t wheel_ticks(double distance) {
+    return static_cast<int32_t>(std::lround(distance / (M_PI * WHEEL_DIAMETER) * 36000.0));
+}
+
+static Odometry::Inputs synthesize(const TruthSample& sample, uint64_t timestamp_us, const Rig& rig) {
+    Odometry::Inputs inputs = {};
+    inputs.timestamp_us = timestamp_us;
+    inputs.v_ticks[0] = wheel_ticks(sample.sx - V_WHEEL_OFFSET * sample.theta);
+    for (std::size_t i = 0; i < rig.h_wheels; i++) inputs.h_ticks[i] = wheel_ticks(sample.sy - H_WHEEL_OFFSETS[i] * sample.theta);
+    double degrees = std::fmod(sample.theta * 180.0 / M_PI, 360.0);
+    inputs.imu_headings[0] = degrees < 0 ? degrees + 360.0 : degrees;
+    return inputs;
+}
+
+struct RunResult {
+    double final_error;
+    double max_error;
+    double heading_error; // largest, radians
+    double ns_per_tick;
+};
+
+static const char* integrator_name(PoseIntegrator integrator) {
+    return integrator == PoseIntegrator::Exponential ? "exponential" : "average";
+}
+
+static RunResult run_synthetic(const std::vector<TruthSample>& truth, uint32_t period_ms, PoseIntegrator integrator,
+    const Rig& rig) {
+    TrackingWheel v_wheel(nullptr, WHEEL_DIAMETER, V_WHEEL_OFFSET);
+    TrackingWheel h_wheel_1(nullptr, WHEEL_DIAMETER, H_WHEEL_OFFSETS[0]);
+    TrackingWheel h_wheel_2(nullptr, WHEEL_DIAMETER, H_WHEEL_OFFSETS[1]);
+    std::vector<TrackingWheel*> h_wheels = {&h_wheel_1, &h_wheel_2};
+    h_wheels.resize(rig.h_wheels);
+    std::vector<pros::IMU*> imus;
+    if (rig.imu) imus.push_back(nullptr);
+    Odometry odometry(imus, {&v_wheel}, h_wheels, 1e-3, 1e-3, 1e-3, 1e-3, 1e-6, 1e-6);
+    odometry.set_filter(OdometryFilter::Ekf);
+    odometry.set_integrator(integrator);
+    odometry.set_health_config({1e6});
+    Pose pose = {0.0f, 0.0f, 0.0f};
+    odometry.reset(pose);
+
+    const std::size_t stride = static_cast<std::size_t>(period_ms * 1e-3 / TRUTH_STEP_S + 0.5);
+    RunResult result = {};
+    std::chrono::nanoseconds elapsed{0};
+    std::size_t ticks = 0;
+    for (std::size_t i = 0; i < truth.size(); i += stride, ticks++) {
+        const Odometry::Inputs inputs = synthesize(truth[i], static_cast<uint64_t>(i * TRUTH_STEP_S * 1e6 + 0.5), rig);
+        auto start = std::chrono::steady_clock::now();
+        odometry.update(pose, inputs);
+        elapsed += std::chrono::steady_clock::now() - start;
+
+        const Vec3& expected = truth[i].pose;
+        result.final_error = std::hypot(pose.x - expected[0], pose.y - expected[1]);
+        result.max_error = std::max(result.max_error, result.final_error);
+        result.heading_error = std::max(result.heading_error, std::abs(wrap_angle(pose.heading - expected[2])));
+    }
+    result.ns_per_tick = static_cast<double>(elapsed.count()) / ticks;
+    return result;
+}
+
+static std::vector<Odometry::Inputs> read_log(const char* path, OdometryLogHeader& header) {
+    std::vector<Odometry::Inputs> records;
+    std::FILE* file = std::fopen(path, "rb");
+    if (!file) return records;
+    // Only the Inputs: decimated replays cannot apply resets and
+    // measurements at the same points, so every replay here skips them.
+    if (read_log_header(file, header)) {
+        OdometryLogRecord record;
+        while (read_log_record(file, header, record)) {
+            if (record.event == OdometryLogEvent::Inputs) records.push_back(record.inputs);
+        }
+    }
+    std::fclose(file);
+    return records;
+}
+
+static std::vector<Pose> replay(const OdometryLogHeader& header, const std::vector<Odometry::Inputs>& records,
+    std::size_t decimation, PoseIntegrator integrator, double& ns_per_tick) {
+    std::vector<TrackingWheel> wheels;
+    wheels.reserve(header.v_wheel_count + header.h_wheel_count);
+    std::vector<TrackingWheel*> v_wheels, h_wheels;
+    for (std::size_t i = 0; i < header.v_wheel_count; i++) {
+        wheels.emplace_back(nullptr, header.v_wheels[i].diameter, header.v_wheels[i].offset);
+        v_wheels.push_back(&wheels.back());
+    }
+    for (std::size_t i = 0; i < header.h_wheel_count; i++) {
+        wheels.emplace_back(nullptr, header.h_wheels[i].diameter, header.h_wheels[i].offset);
+        h_wheels.push_back(&wheels.back());
+    }
+    std::vector<pros::IMU*> imus(header.imu_count, nullptr);
+    Odometry odometry(imus, v_wheels, h_wheels, header.p_x, header.p_y, header.p_theta,
+                      header.r_translation, header.r_heading, header.q);
+    DriveEncoders drive_encoders(nullptr, nullptr, header.drive);
+    if (header.has_drive) odometry.set_drive_encoders(&drive_encoders);
+    odometry.set_filter(OdometryFilter::Ekf);
+    odometry.set_integrator(integrator);
+    for (std::size_t i = 0; i < header.imu_count; i++) odometry.set_imu_drift(i, {header.imu_drift_rates[i], 0});
+    Pose pose = {0.0f, 0.0f, 0.0f};
+    odometry.reset(pose);
+
+    std::vector<Pose> trace;
+    trace.reserve(records.size() / decimation + 1);
+    std::chrono::nanoseconds elapsed{0};
+    for (std::size_t i = 0; i < records.size(); i += decimation) {
+        auto start = std::chrono::steady_clock::now();
+        odometry.update(pose, records[i]);
+        elapsed += std::chrono::steady_clock::now() - start;
+        trace.push_back(pose);
+    }
+    ns_per_tick = trace.empty() ? 0 : static_cast<double>(elapsed.count()) / trace.size();
+    return trace;
+}
+
+static void benchmark_log(const char* path) {
+    OdometryLogHeader header;
+    const std::vector<Odometry::Inputs> records = read_log(path, header);
+    if (records.size() < 2) {
+        std::fprintf(stderr, "%s: not an odometry log or too short\n", path);
+        return;
+    }
+    const double period_ms = (records.back().timestamp_us - records.front().timestamp_us) / 1e3 / (records.size() - 1);
+
+    double ns;
+    const std::vector<Pose> reference = replay(header, records, 1, PoseIntegrator::Exponential, ns);
+    for (std::size_t decimation : {1, 2, 4}) {
+        for (PoseIntegrator integrator : {PoseIntegrator::AverageHeading, PoseIntegrator::Exponential}) {
+            const std::vector<Pose> trace = replay(header, records, decimation, integrator, ns);
+            double final_error = 0, max_error = 0, heading_error = 0;
+            for (std::size_t i = 0; i < trace.size(); i++) {
+                const Pose& expected = reference[i * decimation];
+                final_error = std::hypot(trace[i].x - expected.x, trace[i].y - expected.y);
+                max_error = std::max(max_error, final_error);
+                heading_error = std::max(heading_error, std::abs(wrap_angle(trace[i].heading - expected.heading)));
+            }
+            std::printf("%-12s %-9s %6.1f %-12s %12.6f %12.6f %10.4f %10.1f\n", "recorded", "-", period_ms * decimation,
+                        integrator_name(integrator), final_error, max_error, heading_error * 180 / M_PI, ns);
+        }
+    }
+}
+
+int main(int argc, char** argv) {
+    std::printf("%-12s %-9s %6s %-12s %12s %12s %10s %10s\n", "path", "rig", "ms", "integrator", "final_err", "max_err",
+                "head_deg", "ns/tick");
+    bool ok = true;
+    for (const Path& path : PATHS) {
+        const std::vector<TruthSample> truth = integrate_truth(path);
+        for (const Rig& rig : RIGS) {
+            for (uint32_t period_ms : {5, 10, 20}) {
+                for (PoseIntegrator integrator : {PoseIntegrator::AverageHeading, PoseIntegrator::Exponential}) {
+                    RunResult result = run_synthetic(truth, period_ms, integrator, rig);
+                    const bool within = result.final_error <= MAX_POSITION_ERROR && result.heading_error <= MAX_HEADING_ERROR;
+                    ok = ok && within;
+                    std::printf("%-12s %-9s %6u %-12s %12.6f %12.6f %10.4f %10.1f%s\n", path.name, rig.name, period_ms,
+                                integrator_name(integrator), result.final_error, result.max_error,
+                                result.heading_error * 180 / M_PI, result.ns_per_tick, within ? "" : "  FAIL");
+                }
+            }
+        }
+    }
+    if (argc > 1) benchmark_log(argv[1]);
+    return ok ? 0 : 1;
+}
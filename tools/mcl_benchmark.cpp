@@ -0,0 +1,210 @@
+// Runs the MonteCarloLocalizer (see monte_carlo.h) against a synthetic
+// field. A robot drives a loop around a centre block on a 144 inch field;
+// its odometry has a 1% vertical wheel diameter error and 0.02 degree/second
+// of IMU drift, and four distance sensors see the true walls with 0.5 inch
+// of noise. The loop is run with odometry alone and with the localizer
+// correcting it, reporting the final and RMS position and heading error.
+// Then host time per update() at several particle counts, as particles per
+// millisecond; only useful for comparing counts with each other.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/mcl_benchmark.cpp
+//       src/robot/tracking/monte_carlo.cpp src/robot/tracking/field_map.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/pose_history.cpp
+//       src/robot/tracking/imu_drift.cpp src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o mcl_benchmark
+//
+// Usage:
+//   mcl_benchmark
+//
+// Exits non-zero if the corrected run ends more than MAX_CORRECTED_ERROR off.
+#include "field_map.h"
+#include "monte_carlo.h"
+#include "odometry.h"
+#include "tracking_wheel.h"
+#include "utils/angle.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <random>
+
+static constexpr double DT = 0.01;
+static constexpr int SUBSTEPS = 20;
+static constexpr double DURATION_S = 60.0;
+static constexpr double WHEEL_DIAMETER = 2.0;
+static constexpr double DIAMETER_ERROR = 1.01;
+static constexpr double V_WHEEL_OFFSET = 1.5;
+static constexpr double H_WHEEL_OFFSET = -2.0;
+static constexpr double IMU_DRIFT = 0.02; // degrees/second
+static constexpr double RANGE_SIGMA = 0.5;
+static constexpr float MAX_RANGE = 78.0f;
+static constexpr double MAX_CORRECTED_ERROR = 1.0; // inches
+static constexpr std::size_t TIMING_CYCLES = 2000;
+
+static const Segment BLOCK[] = {
+    {-12.0f, -12.0f, 12.0f, -12.0f},
+    {12.0f, -12.0f, 12.0f, 12.0f},
+    {12.0f, 12.0f, -12.0f, 12.0f},
+    {-12.0f, 12.0f, -12.0f, -12.0f},
+};
+
+// Front, back, left and right; +y is to the robot's right.
+static const float MOUNTS[4][3] = {
+    {6.0f, 0.0f, 0.0f},
+    {-6.0f, 0.0f, static_cast<float>(M_PI)},
+    {0.0f, -6.0f, static_cast<float>(-M_PI / 2)},
+    {0.0f, 6.0f, static_cast<float>(M_PI / 2)},
+};
+
+static FieldMap map;
+
+// Exact distance along the unit ray (dx, dy) to the nearest wall or block
+// face; INFINITY if none.
+static double true_range(double x, double y, double dx, double dy) {
+    double nearest = INFINITY;
+    auto hit = [&](const Segment& segment) {
+        const double sx = segment.x2 - segment.x1, sy = segment.y2 - segment.y1;
+        const double denominator = dx * sy - dy * sx;
+        if (std::abs(denominator) < 1e-12) return;
+        const double qx = segment.x1 - x, qy = segment.y1 - y;
+        const double t = (qx * sy - qy * sx) / denominator;
+        const double u = (qx * dy - qy * dx) / denominator;
+        if (t > 0 && u >= 0 && u <= 1) nearest = std::min(nearest, t);
+    };
+    const float h = FieldMap::half_size;
+    for (const Segment& wall : {Segment{-h, -h, h, -h}, Segment{h, -h, h, h}, Segment{h, h, -h, h}, Segment{-h, h, -h, -h}}) hit(wall);
+    for (const Segment& face : BLOCK) hit(face);
+    return nearest;
+}
+
+struct Truth {
+    double x = 0, y = -40, heading = 0;
+    double sx = 0, sy = 0, theta = 0; // body-frame arc lengths and heading since the start
+
+    void step(double t) {
+        for (int i = 0; i < SUBSTEPS; i++) {
+            const double dt = DT / SUBSTEPS;
+            const double speed = 30.0, omega = 0.75 + 0.15 * std::sin(0.5 * (t + i * dt));
+            x += speed * std::cos(heading + omega * dt / 2) * dt;
+            y += speed * std::sin(heading + omega * dt / 2) * dt;
+            heading += omega * dt;
+            sx += speed * dt;
+            theta += omega * dt;
+        }
+    }
+};
+
+static int32_t wheel_ticks(double distance) {
+    return static_cast<int32_t>(std::lround(distance / (M_PI * WHEEL_DIAMETER) * 36000.0));
+}
+
+static Odometry::Inputs synthesize(const Truth& truth, uint64_t timestamp_us) {
+    Odometry::Inputs inputs = {};
+    inputs.timestamp_us = timestamp_us;
+    inputs.v_ticks[0] = wheel_ticks(truth.sx - V_WHEEL_OFFSET * truth.theta);
+    inputs.h_ticks[0] = wheel_ticks(truth.sy - H_WHEEL_OFFSET * truth.theta);
+    const double degrees = std::fmod((truth.theta + timestamp_us / 1e6 * IMU_DRIFT * M_PI / 180) * 180 / M_PI, 360.0);
+    inputs.imu_headings[0] = degrees < 0 ? degrees + 360.0 : degrees;
+    return inputs;
+}
+
+static MonteCarloLocalizer::Ranges sense(const Truth& truth, std::mt19937& rng) {
+    std::normal_distribution<double> noise(0.0, RANGE_SIGMA);
+    MonteCarloLocalizer::Ranges ranges{};
+    const double s = std::sin(truth.heading), c = std::cos(truth.heading);
+    for (std::size_t i = 0; i < 4; i++) {
+        const double x = truth.x + c * MOUNTS[i][0] - s * MOUNTS[i][1];
+        const double y = truth.y + s * MOUNTS[i][0] + c * MOUNTS[i][1];
+        const double range = true_range(x, y, std::cos(truth.heading + MOUNTS[i][2]), std::sin(truth.heading + MOUNTS[i][2]));
+        ranges[i] = range < MAX_RANGE ? RangeReading{static_cast<int32_t>(std::lround((range + noise(rng)) * 25.4)), 63}
+                                      : RangeReading{9999, 0};
+    }
+    return ranges;
+}
+
+static std::vector<DistanceSensorConfig> sensor_configs() {
+    std::vector<DistanceSensorConfig> sensors;
+    for (const auto& mount : MOUNTS) sensors.push_back({nullptr, mount[0], mount[1], mount[2]});
+    return sensors;
+}
+
+struct Odometer {
+    TrackingWheel v_wheel{nullptr, static_cast<float>(WHEEL_DIAMETER * DIAMETER_ERROR), V_WHEEL_OFFSET};
+    TrackingWheel h_wheel{nullptr, static_cast<float>(WHEEL_DIAMETER), H_WHEEL_OFFSET};
+    Odometry odometry{{nullptr}, {&v_wheel}, {&h_wheel}, 1e-3, 1e-3, 1e-3, 1e-3, 1e-4, 1e-6};
+
+    explicit Odometer(const Pose& start) {
+        odometry.set_filter(OdometryFilter::Ekf);
+        odometry.set_health_config({1e6});
+        odometry.reset(start);
+    }
+};
+
+static void run_loop(bool corrected, bool& ok) {
+    Truth truth;
+    const Pose start(truth.x, truth.y, truth.heading);
+    Odometer odometer(start);
+    MonteCarloLocalizer localizer(&odometer.odometry, &map, sensor_configs());
+    localizer.initialize(start, 1.0f, 0.02f);
+    std::mt19937 rng(7);
+
+    Pose pose = start;
+    double sum_squared = 0, position_error = 0, heading_error = 0, estimate_error = 0;
+    std::size_t ticks = 0;
+    for (double t = 0; t < DURATION_S; t += DT, ticks++) {
+        truth.step(t);
+        const uint64_t timestamp_us = static_cast<uint64_t>((t + DT) * 1e6 + 0.5);
+        odometer.odometry.update(pose, synthesize(truth, timestamp_us));
+        if (corrected) localizer.update(timestamp_us, sense(truth, rng));
+
+        position_error = std::hypot(pose.x - truth.x, pose.y - truth.y);
+        heading_error = std::abs(wrap_angle(pose.heading - truth.heading));
+        sum_squared += position_error * position_error;
+        const Pose estimate = localizer.get_estimate();
+        estimate_error = std::hypot(estimate.x - truth.x, estimate.y - truth.y);
+    }
+    if (corrected) ok = ok && position_error <= MAX_CORRECTED_ERROR;
+    std::printf("%-16s %10.3f %10.3f %10.3f %10.3f\n", corrected ? "odometry + mcl" : "odometry only", position_error,
+                std::sqrt(sum_squared / ticks), heading_error * 180 / M_PI, corrected ? estimate_error : NAN);
+}
+
+// Host time per update() with the robot parked, as particles per millisecond.
+static void time_updates(std::size_t particle_count) {
+    Truth truth;
+    const Pose start(truth.x, truth.y, truth.heading);
+    Odometer odometer(start);
+    MonteCarloConfig config;
+    config.particle_count = particle_count;
+    MonteCarloLocalizer localizer(&odometer.odometry, &map, sensor_configs(), config);
+    localizer.initialize(start, 2.0f, 0.05f);
+    std::mt19937 rng(11);
+
+    std::chrono::nanoseconds elapsed{0};
+    for (std::size_t i = 0; i < TIMING_CYCLES; i++) {
+        const MonteCarloLocalizer::Ranges ranges = sense(truth, rng);
+        const auto begin = std::chrono::steady_clock::now();
+        localizer.update(i * 10'000, ranges);
+        elapsed += std::chrono::steady_clock::now() - begin;
+    }
+    const double us = static_cast<double>(elapsed.count()) / TIMING_CYCLES / 1e3;
+    std::printf("%9zu %12.1f %14.0f\n", particle_count, us, particle_count / us * 1e3);
+}
+
+int main() {
+    for (const Segment& face : BLOCK) map.add_segment(face);
+    map.build();
+
+    bool ok = true;
+    std::printf("%-16s %10s %10s %10s %10s\n", "run", "final_err", "rms_err", "head_deg", "mcl_err");
+    run_loop(false, ok);
+    run_loop(true, ok);
+
+    std::printf("\n%9s %12s %14s\n", "particles", "us/update", "particles/ms");
+    for (std::size_t count : {100, 300, 512}) time_updates(count);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,240 @@
+// Runs the MotionController (see robot/motion.h) against a simulated tank
+// drive and reports, per motion, how it ended, how long it took, the final
+// position and heading error, and the host time per step(); then the same
+// three-point route with each motion stopping and chained (min_speed), a
+// move cancelled partway, which must bring the drive to rest, and the
+// MotionQueue cancel bookkeeping the control task runs each tick. The cost
+// column is only useful for comparing motions with each other; on the
+// robot the control task's LoopStats give the real per-tick figure.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot
+//       -iquote include/utils tools/motion_benchmark.cpp
+//       src/robot/motion.cpp src/robot/path.cpp src/robot/pure_pursuit.cpp
+//       src/utils/pose.cpp -o motion_benchmark
+//
+// Usage:
+//   motion_benchmark
+//
+// Exits non-zero if the cancelled move leaves the drive moving or a cancel
+// ends a motion queued after it.
+#include "motion.h"
+#include "utils/angle.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static constexpr float DT = 0.01f;
+static constexpr double SIDE_SPEED = 60.0 / 127.0; // inches/second per joystick unit
+static constexpr double MOTOR_TIME_CONSTANT = 0.12;
+static constexpr double TRACK_WIDTH = 12.0;
+
+// Tank drive with first-order motor lag. Heading is clockwise positive, so
+// the left side running faster turns towards +y.
+struct Drive {
+    double x = 0, y = 0, heading = 0;
+    double left = 0, right = 0;
+
+    void step(float left_output, float right_output) {
+        left += (SIDE_SPEED * left_output - left) * DT / MOTOR_TIME_CONSTANT;
+        right += (SIDE_SPEED * right_output - right) * DT / MOTOR_TIME_CONSTANT;
+        const double speed = (left + right) / 2;
+        heading += (left - right) / TRACK_WIDTH * DT;
+        x += speed * std::cos(heading) * DT;
+        y += speed * std::sin(heading) * DT;
+    }
+
+    Pose pose() const {
+        return Pose(static_cast<float>(x), static_cast<float>(y), static_cast<float>(heading));
+    }
+};
+
+static const char* status_name(MotionStatus status) {
+    switch (status) {
+        case MotionStatus::Settled: return "settled";
+        case MotionStatus::TimedOut: return "timed out";
+        case MotionStatus::Cancelled: return "cancelled";
+        case MotionStatus::Running: return "running";
+        default: return "idle";
+    }
+}
+
+static void run(const char* name, Drive& drive, const Motion& motion, float target_x, float target_y, float target_heading) {
+    MotionController controller;
+    controller.start(motion);
+    MotionStatus status = MotionStatus::Running;
+    std::chrono::nanoseconds elapsed{0};
+    std::size_t steps = 0;
+    while (status == MotionStatus::Running) {
+        float left, right;
+        const auto start = std::chrono::steady_clock::now();
+        status = controller.step(drive.pose(), DT, left, right);
+        elapsed += std::chrono::steady_clock::now() - start;
+        drive.step(left, right);
+        steps++;
+    }
+    const double position_error = std::hypot(drive.x - target_x, drive.y - target_y);
+    const double heading_error = std::isfinite(target_heading) ? std::abs(wrap_angle(drive.heading - target_heading)) * 180 / M_PI : NAN;
+    std::printf("%-22s %-10s %7.2f %9.3f %9.3f %9.1f\n", name, status_name(status), steps * DT, position_error,
+                heading_error, static_cast<double>(elapsed.count()) / steps);
+}
+
+// Drives through `count` motions back to back, starting each in the tick the
+// previous one ends, as the control task does. Reports the slowest the drive
+// got at a handover.
+static void run_chain(const char* name, const Motion* motions, std::size_t count) {
+    Drive drive;
+    MotionController controller;
+    std::size_t next = 0, steps = 0;
+    double slowest_handover = INFINITY;
+    MotionStatus status = MotionStatus::Idle;
+    while (next < count || controller.active()) {
+        float left = 0.0f, right = 0.0f;
+        while (true) {
+            if (!controller.active()) {
+                if (next == count) break;
+                if (next > 0) slowest_handover = std::min(slowest_handover, std::abs(drive.left + drive.right) / 2);
+                controller.start(motions[next++]);
+            }
+            status = controller.step(drive.pose(), DT, left, right);
+            if (status == MotionStatus::Running) break;
+        }
+        drive.step(left, right);
+        steps++;
+    }
+    std::printf("%-22s %-10s %7.2f  handover at %.1f in/s\n", name, status_name(status), steps * DT, slowest_handover);
+}
+
+// Cancels `motion` after `cancel_s`, holding each tick's command until a new
+// one replaces it as the control task does, and reports how far the drive
+// coasts. Returns whether it has come to rest a second later.
+static bool run_cancel(const char* name, const Motion& motion, float cancel_s) {
+    Drive drive;
+    MotionController controller;
+    controller.start(motion);
+    const std::size_t cancel_step = static_cast<std::size_t>(cancel_s / DT);
+    float left = 0.0f, right = 0.0f;
+    double cancel_x = 0, cancel_y = 0;
+    for (std::size_t steps = 0; steps < cancel_step + static_cast<std::size_t>(1.0f / DT); steps++) {
+        if (steps == cancel_step) {
+            // Chassis::control_loop: a cancel without a new drive command
+            // replaces the held motion output with a stop.
+            controller.cancel();
+            left = right = 0.0f;
+            cancel_x = drive.x;
+            cancel_y = drive.y;
+        }
+        if (controller.active()) controller.step(drive.pose(), DT, left, right);
+        drive.step(left, right);
+    }
+    const double speed = std::abs(drive.left + drive.right) / 2;
+    std::printf("%-22s %-10s %7.2f  coasted %.2f in, %.3f in/s after 1 s\n", name, "cancelled", cancel_s,
+                std::hypot(drive.x - cancel_x, drive.y - cancel_y), speed);
+    return speed < 0.05;
+}
+
+// One control tick as Chassis::control_loop runs it without a new drive
+// command: clear what a cancel covers, then start the next motion. Returns
+// whether anything was cleared.
+static bool control_tick(MotionQueue& queue, MotionController& controller) {
+    const bool cleared = queue.clear(controller, false);
+    queue.start_next(controller);
+    return cleared;
+}
+
+// A cancel must end exactly the motions queued before it: with nothing
+// running (cancel_motions() then returns at once, before the control task
+// has seen it), and with one running and another queued behind the cancel.
+static bool run_cancel_queue() {
+    Motion motion{};
+    motion.type = MotionType::MoveToPoint;
+    motion.x = 24.0f;
+
+    MotionQueue idle;
+    MotionController idle_controller;
+    idle.cancel();
+    const uint32_t queued = idle.push(motion);
+    const bool idle_cleared = control_tick(idle, idle_controller);
+    const bool idle_ok = !idle_cleared && idle_controller.active() && !idle.ended(queued);
+    std::printf("%-22s %-10s cleared=%d running=%d\n", "idle cancel, queue", idle_ok ? "ok" : "FAIL", idle_cleared,
+                idle_controller.active());
+
+    MotionQueue busy;
+    MotionController busy_controller;
+    const uint32_t first = busy.push(motion);
+    control_tick(busy, busy_controller);
+    busy.cancel();
+    const uint32_t second = busy.push(motion);
+    const bool busy_cleared = control_tick(busy, busy_controller);
+    const bool busy_ok = busy_cleared && busy.ended(first) && busy.last_status() == MotionStatus::Cancelled &&
+                         busy_controller.active() && busy.running_id() == second && !busy.ended(second);
+    std::printf("%-22s %-10s cleared=%d running=%d\n", "busy cancel, queue", busy_ok ? "ok" : "FAIL", busy_cleared,
+                busy_controller.active());
+    return idle_ok && busy_ok;
+}
+
+int main() {
+    std::printf("%-22s %-10s %7s %9s %9s %9s\n", "motion", "status", "time_s", "pos_err", "head_deg", "ns/step");
+    Drive drive;
+
+    Motion motion{};
+    motion.type = MotionType::TurnToHeading;
+    motion.heading = static_cast<float>(M_PI / 2);
+    run("turn_to_heading 90", drive, motion, drive.x, drive.y, motion.heading);
+
+    motion.type = MotionType::TurnToHeading;
+    motion.heading = static_cast<float>(-3 * M_PI / 4);
+    run("turn_to_heading -135", drive, motion, drive.x, drive.y, motion.heading);
+
+    motion.type = MotionType::TurnToPoint;
+    motion.x = 24.0f;
+    motion.y = 24.0f;
+    run("turn_to_point", drive, motion, drive.x, drive.y, std::atan2(24.0f - drive.y, 24.0f - drive.x));
+
+    motion.type = MotionType::MoveToPoint;
+    run("move_to_point", drive, motion, 24.0f, 24.0f, NAN);
+
+    motion.type = MotionType::MoveToPoint;
+    motion.x = 0.0f;
+    motion.y = 0.0f;
+    motion.move.forwards = false;
+    run("move_to_point back", drive, motion, 0.0f, 0.0f, NAN);
+
+    motion.type = MotionType::MoveToPose;
+    motion.x = 48.0f;
+    motion.y = 24.0f;
+    motion.heading = 0.0f;
+    motion.move.forwards = true;
+    run("move_to_pose", drive, motion, 48.0f, 24.0f, 0.0f);
+
+    motion.type = MotionType::MoveToPose;
+    motion.x = 0.0f;
+    motion.y = 0.0f;
+    motion.heading = 0.0f;
+    motion.move.forwards = false;
+    run("move_to_pose back", drive, motion, 0.0f, 0.0f, 0.0f);
+
+    std::printf("\n");
+    Motion chain[3] = {};
+    const float points[3][2] = {{24.0f, 0.0f}, {48.0f, 24.0f}, {72.0f, 24.0f}};
+    for (std::size_t i = 0; i < 3; i++) {
+        chain[i].type = MotionType::MoveToPoint;
+        chain[i].x = points[i][0];
+        chain[i].y = points[i][1];
+    }
+    run_chain("3 points stopping", chain, 3);
+    chain[0].move.min_speed = 60.0f;
+    chain[0].move.exit.error = 4.0f;
+    chain[1].move.min_speed = 60.0f;
+    chain[1].move.exit.error = 4.0f;
+    run_chain("3 points chained", chain, 3);
+
+    std::printf("\n");
+    Motion cancel{};
+    cancel.type = MotionType::MoveToPoint;
+    cancel.x = 72.0f;
+    const bool coasted = run_cancel("move_to_point cancel", cancel, 1.0f);
+    const bool queued = run_cancel_queue();
+    return coasted && queued ? 0 : 1;
+}
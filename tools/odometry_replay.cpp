@@ -0,0 +1,176 @@
+// Replays an odometry recording (see odometry_log.h) through the same
+// Odometry filter the robot runs, printing the pose trace as CSV. Resets,
+// fused measurements and learned IMU drift are applied where the live run
+// applied them, and the filter, integrator, noise adaptation and health
+// settings come from the log unless overridden, so an unmodified replay
+// reproduces the live pose. --start sets the pose before the log's first
+// reset.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/odometry_replay.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/odometry_log.cpp
+//       src/robot/tracking/pose_history.cpp src/robot/tracking/imu_drift.cpp
+//       src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o odometry_replay
+//
+// Usage:
+//   odometry_replay <log> [--filter scalar|ekf] [--integrator average|exp]
+//                   [--p_x v] [--p_y v] [--p_theta v] [--r_translation v]
+//                   [--r_heading v] [--q v] [--start x y heading]
+//                   [--adaptive] [--quiet]
+//
+// Exits non-zero if the recorder dropped records, since the replay would
+// then diverge from the live run.
+#include "drive_encoders.h"
+#include "odometry.h"
+#include "odometry_log.h"
+#include "tracking_wheel.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static void usage() {
+    std::fprintf(stderr, "usage: odometry_replay <log> [--filter scalar|ekf] [--integrator average|exp] [--p_x v] [--p_y v]\n"
+                         "                       [--p_theta v] [--r_translation v] [--r_heading v] [--q v]\n"
+                         "                       [--start x y heading] [--adaptive] [--quiet]\n");
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+
+    std::FILE* file = std::fopen(argv[1], "rb");
+    if (!file) {
+        std::perror(argv[1]);
+        return 1;
+    }
+
+    OdometryLogHeader header;
+    if (!read_log_header(file, header)) {
+        std::fprintf(stderr, "%s: not an odometry log\n", argv[1]);
+        return 1;
+    }
+
+    Pose pose = {0.0f, 0.0f, 0.0f};
+    bool quiet = false;
+    NoiseAdaptation adaptation = header.noise_adaptation;
+    PoseIntegrator integrator = static_cast<PoseIntegrator>(header.integrator);
+    for (int i = 2; i < argc; i++) {
+        auto value = [&](double& target) {
+            if (i + 1 >= argc) {
+                usage();
+                std::exit(1);
+            }
+            target = std::atof(argv[++i]);
+        };
+
+        if (!std::strcmp(argv[i], "--filter") && i + 1 < argc) header.filter = std::strcmp(argv[++i], "ekf") ? 0 : 1;
+        else if (!std::strcmp(argv[i], "--integrator") && i + 1 < argc) {
+            integrator = std::strcmp(argv[++i], "exp") ? PoseIntegrator::AverageHeading : PoseIntegrator::Exponential;
+        }
+        else if (!std::strcmp(argv[i], "--p_x")) value(header.p_x);
+        else if (!std::strcmp(argv[i], "--p_y")) value(header.p_y);
+        else if (!std::strcmp(argv[i], "--p_theta")) value(header.p_theta);
+        else if (!std::strcmp(argv[i], "--r_translation")) value(header.r_translation);
+        else if (!std::strcmp(argv[i], "--r_heading")) value(header.r_heading);
+        else if (!std::strcmp(argv[i], "--q")) value(header.q);
+        else if (!std::strcmp(argv[i], "--start") && i + 3 < argc) {
+            pose = Pose(std::atof(argv[i + 1]), std::atof(argv[i + 2]), std::atof(argv[i + 3]));
+            i += 3;
+        }
+        else if (!std::strcmp(argv[i], "--adaptive")) adaptation.enabled = true;
+        else if (!std::strcmp(argv[i], "--quiet")) quiet = true;
+        else {
+            usage();
+            return 1;
+        }
+    }
+
+    // The filter never touches devices when fed recorded inputs, so the
+    // sensor handles can be null.
+    std::vector<TrackingWheel> wheels;
+    wheels.reserve(header.v_wheel_count + header.h_wheel_count);
+    std::vector<TrackingWheel*> v_wheels, h_wheels;
+    for (std::size_t i = 0; i < header.v_wheel_count; i++) {
+        wheels.emplace_back(nullptr, header.v_wheels[i].diameter, header.v_wheels[i].offset);
+        v_wheels.push_back(&wheels.back());
+    }
+    for (std::size_t i = 0; i < header.h_wheel_count; i++) {
+        wheels.emplace_back(nullptr, header.h_wheels[i].diameter, header.h_wheels[i].offset);
+        h_wheels.push_back(&wheels.back());
+    }
+    std::vector<pros::IMU*> imus(header.imu_count, nullptr);
+
+    Odometry odometry(imus, v_wheels, h_wheels, header.p_x, header.p_y, header.p_theta,
+                      header.r_translation, header.r_heading, header.q);
+    odometry.set_filter(header.filter ? OdometryFilter::Ekf : OdometryFilter::Scalar);
+    DriveEncoders drive_encoders(nullptr, nullptr, header.drive);
+    if (header.has_drive) odometry.set_drive_encoders(&drive_encoders);
+    for (std::size_t i = 0; i < header.imu_count; i++) odometry.set_imu_drift(i, {header.imu_drift_rates[i], 0});
+    odometry.set_integrator(integrator);
+    odometry.set_noise_adaptation(adaptation);
+    odometry.set_health_config(header.health);
+    odometry.reset(pose);
+
+    if (!quiet) std::printf("timestamp_us,x,y,heading\n");
+
+    OdometryLogRecord record;
+    uint64_t first_us = 0, last_us = 0;
+    std::size_t ticks = 0;
+    uint32_t dropped = 0;
+    bool faithful = true;
+    auto start = std::chrono::steady_clock::now();
+    while (read_log_record(file, header, record)) {
+        switch (record.event) {
+            case OdometryLogEvent::Inputs: {
+                const Odometry::Inputs& inputs = record.inputs;
+                odometry.update(pose, inputs);
+                if (!quiet) std::printf("%llu,%.6f,%.6f,%.6f\n", static_cast<unsigned long long>(inputs.timestamp_us), pose.x, pose.y, pose.heading);
+                if (ticks++ == 0) first_us = inputs.timestamp_us;
+                last_us = inputs.timestamp_us;
+                break;
+            }
+            case OdometryLogEvent::Reset:
+                pose = record.pose;
+                odometry.reset(pose);
+                break;
+            case OdometryLogEvent::Measurement:
+                // The live tick fused at most the queue's capacity plus the GPS.
+                if (!odometry.submit_measurement(record.measurement)) faithful = false;
+                break;
+            case OdometryLogEvent::ImuDrift:
+                odometry.set_imu_drift(record.imu, record.drift);
+                break;
+            case OdometryLogEvent::Dropped:
+                dropped += record.dropped;
+                break;
+        }
+    }
+    double elapsed_s = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    std::fclose(file);
+
+    double recorded_s = (last_us - first_us) / 1e6;
+    std::fprintf(stderr, "%zu ticks, %.2f s recorded, replayed in %.4f s (%.0fx real time)\n",
+                 ticks, recorded_s, elapsed_s, elapsed_s > 0 ? recorded_s / elapsed_s : 0.0);
+    if (adaptation.enabled) {
+        NoiseEstimate noise = odometry.get_noise();
+        std::fprintf(stderr, "final noise: r_translation %g, r_heading %g, q %g\n", noise.r_translation, noise.r_heading, noise.q);
+    }
+    if (dropped > 0) {
+        std::fprintf(stderr, "%s: the recorder dropped %u records; this replay does not match the live run\n", argv[1], dropped);
+        return 1;
+    }
+    if (!faithful) {
+        std::fprintf(stderr, "%s: more measurements in one tick than replay can queue; this replay does not match the live run\n", argv[1]);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,122 @@
+// Step responses and per-update cost of the Pid in
+// autonomous/controllers/pid.h.
+//
+// Each case drives a simulated drivetrain (first-order motor lag plus an
+// integrator, position in inches, output in joystick units) from 0 to a
+// 24 inch setpoint and checks the canonical step response figures: it must
+// settle within the case's time and overshoot bound with no steady-state
+// error, and settled() must agree. The process exits non-zero if any case
+// fails. Cost is host time per update() for several option sets, useful only
+// for comparing them with each other.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include tools/pid_benchmark.cpp -o pid_benchmark
+//
+// Usage:
+//   pid_benchmark
+#include "autonomous/controllers/pid.h"
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static constexpr double DT = 0.01;
+static constexpr double SETPOINT = 24.0;
+static constexpr double MOTOR_GAIN = 60.0 / 127.0; // inches/second per joystick unit at steady state
+static constexpr double MOTOR_TIME_CONSTANT = 0.15;
+static constexpr std::size_t BENCHMARK_UPDATES = 10'000'000;
+static constexpr std::size_t BENCHMARK_SEGMENT = 100;
+
+// Position and velocity of the simulated drivetrain.
+struct Plant {
+    double position = 0;
+    double velocity = 0;
+
+    void step(double output, double disturbance) {
+        const double target = MOTOR_GAIN * output + disturbance;
+        velocity += (target - velocity) * DT / MOTOR_TIME_CONSTANT;
+        position += velocity * DT;
+    }
+};
+
+struct StepResponse {
+    double rise_time;       // 10% to 90% of the step, seconds
+    double overshoot;       // past the setpoint, percent of the step
+    double settle_time;     // last time outside 2% of the step
+    double final_error;
+    double reported_settle; // first time settled() was true, or -1
+};
+
+template <typename T, PidOptions Options>
+static StepResponse step_response(PidGains<T> gains, PidConfig<T> config, double disturbance, double duration) {
+    Pid<T, Options> pid(gains, config);
+    Plant plant;
+    StepResponse response = {-1, 0, 0, 0, -1};
+    double t10 = -1;
+    const std::size_t steps = static_cast<std::size_t>(duration / DT);
+    for (std::size_t i = 0; i < steps; i++) {
+        const double t = i * DT;
+        const T output = pid.update(static_cast<T>(SETPOINT), static_cast<T>(plant.position), static_cast<T>(DT));
+        plant.step(output, disturbance);
+
+        if (t10 < 0 && plant.position >= 0.1 * SETPOINT) t10 = t;
+        if (response.rise_time < 0 && plant.position >= 0.9 * SETPOINT) response.rise_time = t - t10;
+        response.overshoot = std::max(response.overshoot, (plant.position - SETPOINT) / SETPOINT * 100);
+        if (std::abs(plant.position - SETPOINT) > 0.02 * SETPOINT) response.settle_time = t + DT;
+        if constexpr (Options.settle_detection) {
+            if (response.reported_settle < 0 && pid.settled()) response.reported_settle = t;
+        }
+    }
+    response.final_error = SETPOINT - plant.position;
+    return response;
+}
+
+static bool check(const char* name, const StepResponse& response, double max_settle, double max_overshoot,
+    bool expect_reported) {
+    const bool ok = response.rise_time > 0 && response.settle_time <= max_settle && response.overshoot <= max_overshoot
+        && std::abs(response.final_error) < 0.05 && (!expect_reported || response.reported_settle >= 0);
+    std::printf("%-28s %8.3f %9.2f %8.3f %10.4f %8.3f  %s\n", name, response.rise_time, response.overshoot,
+                response.settle_time, response.final_error, response.reported_settle, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+template <typename T, PidOptions Options>
+static double ns_per_update(PidGains<T> gains) {
+    Pid<T, Options> pid(gains);
+    volatile T sink = 0;
+    T measurement = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < BENCHMARK_UPDATES; i++) {
+        // A square wave setpoint keeps the state away from denormals, which
+        // a converged loop on the host would otherwise decay into.
+        const T setpoint = static_cast<T>((i / BENCHMARK_SEGMENT) % 2 ? SETPOINT : 0.0);
+        const T output = pid.update(setpoint, measurement, static_cast<T>(DT));
+        measurement += output * static_cast<T>(1e-4);
+        sink = output;
+    }
+    const auto elapsed = std::chrono::steady_clock::now() - start;
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(elapsed).count() / BENCHMARK_UPDATES;
+}
+
+int main() {
+    static constexpr PidOptions MINIMAL = {false, false, false, false, false, false};
+    static constexpr PidOptions DEFAULT = {};
+    static constexpr PidOptions FULL = {true, true, true, true, true, false};
+    static constexpr PidOptions ANGULAR = {true, true, true, false, true, true};
+
+    std::printf("%-28s %8s %9s %8s %10s %8s\n", "case", "rise_s", "overshoot", "settle_s", "final_err", "settled");
+    bool ok = true;
+    ok &= check("pd double", step_response<double, DEFAULT>({12, 0, 1.2}, {}, 0, 4), 1.5, 2, true);
+    ok &= check("pd float", step_response<float, DEFAULT>({12, 0, 1.2}, {}, 0, 4), 1.5, 2, true);
+    ok &= check("pid with disturbance", step_response<double, DEFAULT>({12, 6, 1.2}, {127, 40, 4}, -5, 6), 4, 10, true);
+    ok &= check("pid slew limited", step_response<double, FULL>({12, 6, 1.2}, {127, 40, 4, 0.02, 400}, -5, 6), 4, 10, true);
+    ok &= check("pd unfiltered", step_response<double, MINIMAL>({12, 0, 1.2}, {}, 0, 4), 1.5, 2, false);
+
+    std::printf("\n%-28s %10s\n", "options", "ns/update");
+    std::printf("%-28s %10.2f\n", "minimal double", ns_per_update<double, MINIMAL>({12, 6, 1.2}));
+    std::printf("%-28s %10.2f\n", "default double", ns_per_update<double, DEFAULT>({12, 6, 1.2}));
+    std::printf("%-28s %10.2f\n", "full double", ns_per_update<double, FULL>({12, 6, 1.2}));
+    std::printf("%-28s %10.2f\n", "default float", ns_per_update<float, DEFAULT>({12, 6, 1.2}));
+    std::printf("%-28s %10.2f\n", "angular double", ns_per_update<double, ANGULAR>({12, 6, 1.2}));
+    return ok ? 0 : 1;
+}
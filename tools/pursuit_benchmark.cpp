@@ -0,0 +1,128 @@
+// Follows serpentine paths of growing length (0.1 inch spacing, 1k to 1M
+// points) with the MotionController's pure pursuit against a simulated tank
+// drive. Per path it reports how the follow ended, the largest distance from
+// the path, host time per step(), and for contrast the time of one full O(n)
+// closest-point scan, which is what a non-incremental search pays per tick.
+// The step cost should stay flat as the path grows.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot
+//       -iquote include/utils tools/pursuit_benchmark.cpp src/robot/motion.cpp
+//       src/robot/path.cpp src/robot/pure_pursuit.cpp src/utils/pose.cpp
+//       -o pursuit_benchmark
+//
+// Usage:
+//   pursuit_benchmark
+#include "motion.h"
+#include "path.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+
+static constexpr float DT = 0.01f;
+static constexpr double SIDE_SPEED = 60.0 / 127.0; // inches/second per joystick unit
+static constexpr double MOTOR_TIME_CONSTANT = 0.12;
+static constexpr double TRACK_WIDTH = 12.0;
+static constexpr float SPACING = 0.1f;
+static constexpr std::size_t ERROR_WINDOW = 2000;
+static constexpr std::size_t SCAN_SAMPLES = 200;
+
+// Tank drive with first-order motor lag; heading clockwise positive.
+struct Drive {
+    double x = 0, y = 0, heading = 0;
+    double left = 0, right = 0;
+
+    void step(float left_output, float right_output) {
+        left += (SIDE_SPEED * left_output - left) * DT / MOTOR_TIME_CONSTANT;
+        right += (SIDE_SPEED * right_output - right) * DT / MOTOR_TIME_CONSTANT;
+        const double speed = (left + right) / 2;
+        heading += (left - right) / TRACK_WIDTH * DT;
+        x += speed * std::cos(heading) * DT;
+        y += speed * std::sin(heading) * DT;
+    }
+
+    Pose pose() const {
+        return Pose(static_cast<float>(x), static_cast<float>(y), static_cast<float>(heading));
+    }
+};
+
+// Gentle S-bends: 24 inch amplitude over a 120 inch wavelength.
+static Path serpentine(std::size_t points) {
+    Path path;
+    path.reserve(points);
+    for (std::size_t i = 0; i < points; i++) {
+        const float x = i * SPACING;
+        path.add_point(x, 24.0f * std::sin(x * static_cast<float>(2 * M_PI / 120)));
+    }
+    path.finish();
+    return path;
+}
+
+static std::size_t full_scan(const Path& path, float x, float y) {
+    std::size_t best = 0;
+    float best_distance = INFINITY;
+    for (std::size_t i = 0; i < path.size(); i++) {
+        const float d = (path.x[i] - x) * (path.x[i] - x) + (path.y[i] - y) * (path.y[i] - y);
+        if (d < best_distance) {
+            best_distance = d;
+            best = i;
+        }
+    }
+    return best;
+}
+
+static void run(std::size_t points) {
+    const Path path = serpentine(points);
+    Drive drive;
+    drive.heading = std::atan2(path.y[1] - path.y[0], path.x[1] - path.x[0]);
+
+    Motion motion{};
+    motion.type = MotionType::FollowPath;
+    motion.path = &path;
+    motion.move.timeout_ms = static_cast<uint32_t>(path.distance.back() / 20.0f * 1000.0f) + 5000;
+    MotionController controller;
+    controller.start(motion);
+
+    MotionStatus status = MotionStatus::Running;
+    std::chrono::nanoseconds elapsed{0};
+    std::size_t steps = 0, nearest = 0;
+    double max_error = 0;
+    while (status == MotionStatus::Running) {
+        float left, right;
+        const auto start = std::chrono::steady_clock::now();
+        status = controller.step(drive.pose(), DT, left, right);
+        elapsed += std::chrono::steady_clock::now() - start;
+        drive.step(left, right);
+        steps++;
+
+        // Distance from the path, searched around the last nearest point.
+        const std::size_t begin = nearest > ERROR_WINDOW ? nearest - ERROR_WINDOW : 0;
+        const std::size_t end = std::min(nearest + ERROR_WINDOW, path.size());
+        double best = INFINITY;
+        for (std::size_t i = begin; i < end; i++) {
+            const double d = std::hypot(path.x[i] - drive.x, path.y[i] - drive.y);
+            if (d < best) {
+                best = d;
+                nearest = i;
+            }
+        }
+        max_error = std::max(max_error, best);
+    }
+
+    const auto start = std::chrono::steady_clock::now();
+    volatile std::size_t sink = 0;
+    for (std::size_t i = 0; i < SCAN_SAMPLES; i++) sink = full_scan(path, static_cast<float>(drive.x), static_cast<float>(drive.y) + i);
+    (void)sink;
+    const double scan_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / SCAN_SAMPLES;
+
+    std::printf("%9zu %10.0f %-10s %9.3f %9.1f %12.0f\n", points, path.distance.back(),
+                status == MotionStatus::Settled ? "settled" : "timed out", max_error,
+                static_cast<double>(elapsed.count()) / steps, scan_ns);
+}
+
+int main() {
+    std::printf("%9s %10s %-10s %9s %9s %12s\n", "points", "length_in", "status", "max_err", "ns/step", "scan_ns");
+    for (std::size_t points : {1'000, 10'000, 100'000, 1'000'000}) run(points);
+    return 0;
+}
@@ -0,0 +1,100 @@
+// Host cost of the per-device sampling in Odometry::sample() (see
+// device_sampling.h): median_position() over 2 to 8 drive motors, against a
+// get_position_all()-style read that returns a vector, and sample_device()
+// on each of its paths (not due, a repeated value, a fresh value) for the
+// three reading types it handles. The devices are stand-ins that return
+// stored values, so the figures are the sampling logic alone, without the
+// V5 kernel calls; only useful for comparing the cases with each other.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/sampling_benchmark.cpp
+//       src/robot/tracking/drive_encoders.cpp -o sampling_benchmark
+//
+// Usage:
+//   sampling_benchmark
+#include "device_sampling.h"
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+static constexpr std::size_t CALLS = 2'000'000;
+
+// MotorGroup stand-in: positions drift a little each read.
+struct Motors {
+    std::size_t count;
+    std::array<double, DriveEncoders::max_motors> positions{};
+
+    std::size_t size() const { return count; }
+
+    double get_position(std::size_t index) {
+        positions[index] += 0.5 + index * 0.01;
+        return positions[index];
+    }
+
+    std::vector<double> get_position_all() {
+        std::vector<double> all(count);
+        for (std::size_t i = 0; i < count; i++) all[i] = get_position(i);
+        return all;
+    }
+};
+
+static double median_all(Motors* motors) {
+    const std::vector<double> all = motors->get_position_all();
+    std::array<double, DriveEncoders::max_motors> positions;
+    std::copy(all.begin(), all.end(), positions.begin());
+    return DriveEncoders::median(positions, all.size());
+}
+
+template <typename F>
+static double ns_per_call(F&& call) {
+    volatile double sink = 0;
+    const auto start = std::chrono::steady_clock::now();
+    for (std::size_t i = 0; i < CALLS; i++) sink = sink + call(i);
+    (void)sink;
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / CALLS;
+}
+
+// `next(i)` gives the device's reading on call i; `now(i)` the tick time.
+// With a fixed `now`, a period of 0 leaves every call due.
+template <typename Value, typename Next, typename Now>
+static double time_sample(uint32_t period_ms, Next next, Now now) {
+    Value value{};
+    uint64_t due = 0, sample_us = 0;
+    SampleStats stats;
+    return ns_per_call([&](std::size_t i) {
+        return static_cast<double>(sample_device(now(i), period_ms, due, stats, value, sample_us,
+                                                 [&] { return next(i); }) == SampleResult::Fresh);
+    });
+}
+
+int main() {
+    std::printf("%-26s %10s %10s\n", "median_position", "ns/call", "vector_ns");
+    for (std::size_t count : {2, 4, 6, 8}) {
+        Motors motors{count};
+        const double stack = ns_per_call([&](std::size_t) { return median_position(&motors); });
+        const double vector = ns_per_call([&](std::size_t) { return median_all(&motors); });
+        char name[32];
+        std::snprintf(name, sizeof(name), "%zu motors", count);
+        std::printf("%-26s %10.1f %10.1f\n", name, stack, vector);
+    }
+
+    const auto tick = [](std::size_t i) { return static_cast<uint64_t>(i) * 5'000; };
+    const auto fixed_time = [](std::size_t) { return uint64_t{0}; };
+    std::printf("\n%-26s %10s\n", "sample_device", "ns/call");
+    // Due only every 10 ms at a 5 ms tick, so half the calls return early.
+    std::printf("%-26s %10.1f\n", "rotation, half not due", time_sample<int32_t>(10, [](std::size_t i) {
+        return static_cast<int32_t>(i * 37); }, tick));
+    std::printf("%-26s %10.1f\n", "rotation, repeat", time_sample<int32_t>(0, [](std::size_t) { return int32_t{42}; }, fixed_time));
+    std::printf("%-26s %10.1f\n", "rotation, fresh", time_sample<int32_t>(0, [](std::size_t i) {
+        return static_cast<int32_t>(i * 37); }, fixed_time));
+    std::printf("%-26s %10.1f\n", "imu, fresh", time_sample<double>(0, [](std::size_t i) {
+        return std::fmod(i * 0.01, 360.0); }, fixed_time));
+    Motors left{4}, right{4};
+    std::printf("%-26s %10.1f\n", "drive 2x4 motors, fresh", time_sample<std::array<double, 2>>(0, [&](std::size_t) {
+        return std::array<double, 2>{median_position(&left), median_position(&right)}; }, fixed_time));
+    return 0;
+}
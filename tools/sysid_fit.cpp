@@ -0,0 +1,215 @@
+// Fits the drive model (see drive_model.h) to a CSV written by
+// Chassis::run_sysid(). Linear motion uses the sides' mean, angular motion
+// half their difference; each is fitted by least squares to
+//   V = kS sgn(v) + kV v + kA a
+// where V is the commanded voltage scaled by battery / nominal, matching the
+// compensation the drive applies. Acceleration is re-derived from velocity
+// with a central difference over five samples, which is far less noisy than
+// the logged one-sample difference. Samples slower than --min_velocity are
+// left out, since static friction there is not kS sgn(v).
+//
+// Confidence figures per fit: R^2, RMS residual in volts, and the standard
+// error of each constant. A standard error near the constant itself means
+// the run did not excite that term; rerun with a larger ramp or step.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot
+//       -iquote include/utils tools/sysid_fit.cpp src/robot/drive_model.cpp
+//       -o sysid_fit
+//
+// Usage:
+//   sysid_fit <csv> [--min_velocity v] [--out model.txt]
+#include "drive_model.h"
+#include "matrix.h"
+#include "sysid.h"
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+static constexpr std::size_t ACCELERATION_SPAN = 2;
+
+struct Fit {
+    Feedforward ff;
+    Vec3 standard_error;
+    double r_squared;
+    double rms;
+    std::size_t samples;
+};
+
+static void usage() {
+    std::fprintf(stderr, "usage: sysid_fit <csv> [--min_velocity v] [--out model.txt]\n");
+}
+
+static bool parse_test(const char* name, SysidTest& test) {
+    for (SysidTest candidate : {SysidTest::QuasistaticLinear, SysidTest::QuasistaticAngular,
+                                SysidTest::DynamicLinear, SysidTest::DynamicAngular}) {
+        if (std::strcmp(name, sysid_test_name(candidate)) == 0) {
+            test = candidate;
+            return true;
+        }
+    }
+    return false;
+}
+
+static std::vector<SysidSample> read_csv(const char* path) {
+    std::vector<SysidSample> samples;
+    std::FILE* file = std::fopen(path, "r");
+    if (!file) return samples;
+
+    char line[256];
+    char name[32];
+    while (std::fgets(line, sizeof(line), file)) {
+        SysidSample sample;
+        int direction;
+        unsigned long time_ms;
+        if (std::sscanf(line, "%31[^,],%d,%lu,%f,%f,%f,%f,%f,%f,%f", name, &direction, &time_ms,
+                        &sample.left_volts, &sample.right_volts, &sample.left_velocity, &sample.right_velocity,
+                        &sample.left_acceleration, &sample.right_acceleration, &sample.battery_volts) != 10) continue;
+        if (!parse_test(name, sample.test)) continue;
+        sample.direction = static_cast<int8_t>(direction);
+        sample.time_ms = static_cast<uint32_t>(time_ms);
+        samples.push_back(sample);
+    }
+    std::fclose(file);
+    return samples;
+}
+
+static bool same_run(const SysidSample& a, const SysidSample& b) {
+    return a.test == b.test && a.direction == b.direction;
+}
+
+static bool is_angular(SysidTest test) {
+    return test == SysidTest::QuasistaticAngular || test == SysidTest::DynamicAngular;
+}
+
+// Solves the 3x3 normal equations; false if they are singular.
+static bool solve(const Mat3& a, const Vec3& b, Vec3& x, Mat3& inverse) {
+    const double det = a(0, 0) * (a(1, 1) * a(2, 2) - a(1, 2) * a(2, 1))
+                     - a(0, 1) * (a(1, 0) * a(2, 2) - a(1, 2) * a(2, 0))
+                     + a(0, 2) * (a(1, 0) * a(2, 1) - a(1, 1) * a(2, 0));
+    if (std::abs(det) < 1e-12) return false;
+    for (std::size_t i = 0; i < 3; i++) {
+        for (std::size_t j = 0; j < 3; j++) {
+            const std::size_t r0 = (j + 1) % 3, r1 = (j + 2) % 3, c0 = (i + 1) % 3, c1 = (i + 2) % 3;
+            inverse(i, j) = (a(r0, c0) * a(r1, c1) - a(r0, c1) * a(r1, c0)) / det;
+        }
+    }
+    for (std::size_t i = 0; i < 3; i++) x[i] = inverse(i, 0) * b[0] + inverse(i, 1) * b[1] + inverse(i, 2) * b[2];
+    return true;
+}
+
+static bool fit(const std::vector<SysidSample>& samples, bool angular, double min_velocity, Fit& result) {
+    struct Row {
+        double sign, velocity, acceleration, volts;
+    };
+    std::vector<Row> rows;
+    for (std::size_t i = 0; i < samples.size(); i++) {
+        const SysidSample& sample = samples[i];
+        if (is_angular(sample.test) != angular) continue;
+
+        const double side = angular ? -1.0 : 1.0;
+        const auto combine = [side](double left, double right) { return (left + side * right) / 2; };
+        const double velocity = combine(sample.left_velocity, sample.right_velocity);
+        if (std::abs(velocity) < min_velocity) continue;
+
+        double acceleration = combine(sample.left_acceleration, sample.right_acceleration);
+        if (i >= ACCELERATION_SPAN && i + ACCELERATION_SPAN < samples.size()
+            && same_run(samples[i - ACCELERATION_SPAN], sample) && same_run(samples[i + ACCELERATION_SPAN], sample)) {
+            const SysidSample& before = samples[i - ACCELERATION_SPAN];
+            const SysidSample& after = samples[i + ACCELERATION_SPAN];
+            const double dt = (after.time_ms - before.time_ms) / 1000.0;
+            if (dt > 0) {
+                acceleration = (combine(after.left_velocity, after.right_velocity)
+                                - combine(before.left_velocity, before.right_velocity)) / dt;
+            }
+        }
+
+        const double battery = std::isfinite(sample.battery_volts) ? sample.battery_volts : NOMINAL_BATTERY_VOLTS;
+        const double volts = combine(sample.left_volts, sample.right_volts) * battery / NOMINAL_BATTERY_VOLTS;
+        rows.push_back({velocity > 0 ? 1.0 : -1.0, velocity, acceleration, volts});
+    }
+    if (rows.size() < 4) return false;
+
+    Mat3 normal;
+    Vec3 rhs = {0, 0, 0};
+    for (const Row& row : rows) {
+        const Vec3 x = {row.sign, row.velocity, row.acceleration};
+        for (std::size_t i = 0; i < 3; i++) {
+            for (std::size_t j = 0; j < 3; j++) normal(i, j) += x[i] * x[j];
+            rhs[i] += x[i] * row.volts;
+        }
+    }
+    Vec3 k;
+    Mat3 inverse;
+    if (!solve(normal, rhs, k, inverse)) return false;
+
+    double mean = 0;
+    for (const Row& row : rows) mean += row.volts;
+    mean /= rows.size();
+    double residual = 0, total = 0;
+    for (const Row& row : rows) {
+        const double error = row.volts - (k[0] * row.sign + k[1] * row.velocity + k[2] * row.acceleration);
+        residual += error * error;
+        total += (row.volts - mean) * (row.volts - mean);
+    }
+    const double variance = residual / (rows.size() - 3);
+
+    result.ff = {k[0], k[1], k[2]};
+    for (std::size_t i = 0; i < 3; i++) result.standard_error[i] = std::sqrt(variance * inverse(i, i));
+    result.r_squared = total > 0 ? 1 - residual / total : 0;
+    result.rms = std::sqrt(residual / rows.size());
+    result.samples = rows.size();
+    return true;
+}
+
+static void print_fit(const char* name, const Fit& fit) {
+    std::printf("%s (%zu samples): R^2 %.4f, RMS %.3f V\n", name, fit.samples, fit.r_squared, fit.rms);
+    std::printf("  ks %10.5f +- %.5f V\n", fit.ff.ks, fit.standard_error[0]);
+    std::printf("  kv %10.5f +- %.5f V/(in/s)\n", fit.ff.kv, fit.standard_error[1]);
+    std::printf("  ka %10.5f +- %.5f V/(in/s^2)\n", fit.ff.ka, fit.standard_error[2]);
+}
+
+int main(int argc, char** argv) {
+    if (argc < 2) {
+        usage();
+        return 1;
+    }
+    double min_velocity = 0.5;
+    const char* out = nullptr;
+    for (int i = 2; i < argc; i++) {
+        if (std::strcmp(argv[i], "--min_velocity") == 0 && i + 1 < argc) {
+            min_velocity = std::atof(argv[++i]);
+        } else if (std::strcmp(argv[i], "--out") == 0 && i + 1 < argc) {
+            out = argv[++i];
+        } else {
+            usage();
+            return 1;
+        }
+    }
+
+    const std::vector<SysidSample> samples = read_csv(argv[1]);
+    if (samples.empty()) {
+        std::fprintf(stderr, "%s: no sysid samples\n", argv[1]);
+        return 1;
+    }
+
+    Fit linear, angular;
+    if (!fit(samples, false, min_velocity, linear) || !fit(samples, true, min_velocity, angular)) {
+        std::fprintf(stderr, "%s: not enough moving samples to fit both linear and angular motion\n", argv[1]);
+        return 1;
+    }
+    print_fit("linear", linear);
+    print_fit("angular", angular);
+
+    const DriveModel model = {linear.ff, angular.ff, 0.0};
+    std::printf("\nDriveModel model = {{%.5f, %.5f, %.5f}, {%.5f, %.5f, %.5f}, kp};\n",
+                model.linear.ks, model.linear.kv, model.linear.ka,
+                model.angular.ks, model.angular.kv, model.angular.ka);
+    if (out && !save_drive_model(out, model)) {
+        std::fprintf(stderr, "%s: could not write model\n", out);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,141 @@
+// Checks FastTrig (see utils/trig.h) against its documented error bounds and
+// wrap_angle (utils/angle.h) on large and non-finite angles, then times each
+// FastTrig call against LibmTrig. Errors are taken against libm over a dense
+// sweep of the documented input range. Times are host nanoseconds per call,
+// plus timestamp counter ticks on x86; only useful for comparing the two
+// policies with each other, not as a figure for the V5 brain.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include tools/trig_benchmark.cpp -o trig_benchmark
+//
+// Usage:
+//   trig_benchmark
+//
+// Exits non-zero if any bound or wrap_angle check fails.
+#include "utils/angle.h"
+#include "utils/trig.h"
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <vector>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define HAVE_TSC 1
+#endif
+
+static constexpr double SINCOS_RANGE = 1000.0;
+static constexpr double SINCOS_BOUND = 3e-8;
+static constexpr double ATAN2_BOUND = 2e-6;
+static constexpr std::size_t SWEEP_POINTS = 20'000'000;
+static constexpr std::size_t ATAN2_GRID = 4000;
+static constexpr std::size_t TIMING_INPUTS = 4096;
+static constexpr std::size_t TIMING_ROUNDS = 2000;
+
+static bool check(const char* name, double error, double bound) {
+    const bool ok = error < bound;
+    std::printf("%-28s %12.3g %12.3g  %s\n", name, error, bound, ok ? "ok" : "FAIL");
+    return ok;
+}
+
+static bool check_sincos() {
+    double sin_error = 0, cos_error = 0;
+    for (std::size_t i = 0; i <= SWEEP_POINTS; i++) {
+        const double x = -SINCOS_RANGE + 2 * SINCOS_RANGE * i / SWEEP_POINTS;
+        double s, c;
+        FastTrig::sincos(x, s, c);
+        sin_error = std::max(sin_error, std::abs(s - std::sin(x)));
+        cos_error = std::max(cos_error, std::abs(c - std::cos(x)));
+    }
+    const bool sin_ok = check("sin, |x| < 1000", sin_error, SINCOS_BOUND);
+    return check("cos, |x| < 1000", cos_error, SINCOS_BOUND) && sin_ok;
+}
+
+// Points on rings of radius 1e-3 to 1e3 around the origin, plus the axes.
+static bool check_atan2() {
+    double error = 0;
+    for (double radius : {1e-3, 1.0, 1e3}) {
+        for (std::size_t i = 0; i < ATAN2_GRID; i++) {
+            const double angle = -M_PI + 2 * M_PI * i / ATAN2_GRID;
+            const double y = radius * std::sin(angle), x = radius * std::cos(angle);
+            error = std::max(error, std::abs(wrap_angle(FastTrig::atan2(y, x) - std::atan2(y, x))));
+        }
+    }
+    for (double x : {1.0, -1.0}) error = std::max(error, std::abs(FastTrig::atan2(0.0, x) - std::atan2(0.0, x)));
+    for (double y : {1.0, -1.0}) error = std::max(error, std::abs(FastTrig::atan2(y, 0.0) - std::atan2(y, 0.0)));
+    return check("atan2", error, ATAN2_BOUND);
+}
+
+static bool check_wrap_angle() {
+    double error = 0;
+    for (double angle : {0.0, 3.0, -3.0, 7.0, -100.0, 1e6, -1e6, 1e9, 1e12, -1e15, 1e300}) {
+        const double wrapped = wrap_angle(angle);
+        const double expected = std::remainder(angle, 2 * M_PI);
+        // Within the int32 path, rounding in angle - whole * 2pi grows with |angle|.
+        error = std::max(error, std::abs(wrapped - expected) / std::max(1.0, std::abs(angle) * 1e-15));
+        if (std::abs(wrapped) > M_PI + 1e-9) error = INFINITY;
+    }
+    bool ok = check("wrap_angle, finite", error, 1e-6);
+    const double infinity = std::numeric_limits<double>::infinity();
+    for (double angle : {std::numeric_limits<double>::quiet_NaN(), infinity, -infinity}) {
+        ok = ok && std::isnan(wrap_angle(angle));
+    }
+    std::printf("%-28s %12s %12s  %s\n", "wrap_angle, NaN and inf", "", "NaN", ok ? "ok" : "FAIL");
+    return ok;
+}
+
+struct Cost {
+    double ns;
+    double ticks;
+};
+
+template <typename F>
+static Cost time_calls(const std::vector<double>& inputs, F&& call) {
+    volatile double sink = 0;
+    double sum = 0;
+    const auto begin = std::chrono::steady_clock::now();
+#ifdef HAVE_TSC
+    const unsigned long long begin_ticks = __rdtsc();
+#endif
+    for (std::size_t round = 0; round < TIMING_ROUNDS; round++) {
+        for (std::size_t i = 0; i < inputs.size(); i++) sum += call(inputs[i], inputs[inputs.size() - 1 - i]);
+    }
+#ifdef HAVE_TSC
+    const double ticks = static_cast<double>(__rdtsc() - begin_ticks);
+#else
+    const double ticks = NAN;
+#endif
+    const double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - begin).count();
+    sink = sum;
+    (void)sink;
+    const double calls = static_cast<double>(TIMING_ROUNDS * inputs.size());
+    return {ns / calls, ticks / calls};
+}
+
+template <typename Policy>
+static void time_policy(const char* name, const std::vector<double>& inputs) {
+    const Cost sincos = time_calls(inputs, [](double x, double) {
+        double s, c;
+        Policy::sincos(x, s, c);
+        return s + c;
+    });
+    const Cost atan2 = time_calls(inputs, [](double y, double x) { return Policy::atan2(y, x); });
+    std::printf("%-10s %12.2f %12.1f %12.2f %12.1f\n", name, sincos.ns, sincos.ticks, atan2.ns, atan2.ticks);
+}
+
+int main() {
+    std::printf("%-28s %12s %12s\n", "check", "max_err", "bound");
+    bool ok = check_sincos();
+    ok = check_atan2() && ok;
+    ok = check_wrap_angle() && ok;
+
+    // Headings a control loop sees: a few turns either way.
+    std::vector<double> inputs(TIMING_INPUTS);
+    for (std::size_t i = 0; i < inputs.size(); i++) inputs[i] = -20.0 + 40.0 * ((i * 2654435761u) % TIMING_INPUTS) / TIMING_INPUTS;
+
+    std::printf("\n%-10s %12s %12s %12s %12s\n", "policy", "sincos_ns", "sincos_tsc", "atan2_ns", "atan2_tsc");
+    time_policy<LibmTrig>("libm", inputs);
+    time_policy<FastTrig>("fast", inputs);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,78 @@
+// Long-run drift of TrackingWheel (see tracking_wheel.h). A wheel is driven
+// back and forth with a net forward creep for millions of ticks, with the
+// raw Rotation position starting just below INT32_MAX so it rolls over
+// within the first few ticks and again every 2^32 ticks after. Every tick
+// peek_delta() must equal the true tick delta, and the accumulated total
+// must match the true tick count exactly. The summed get_distance_delta()
+// values are compared with get_distance_total(), and a float accumulator
+// is shown for contrast.
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       tools/wheel_drift.cpp src/robot/tracking/tracking_wheel.cpp
+//       -o wheel_drift
+//
+// Usage:
+//   wheel_drift [ticks]
+//
+// Exits non-zero if any delta or the final total is off by a tick, the
+// summed deltas drift more than MAX_SUM_DRIFT from the total, or the run is
+// too short to roll over.
+#include "tracking_wheel.h"
+#include <algorithm>
+#include <cinttypes>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+
+static constexpr double WHEEL_DIAMETER = 2.75;
+static constexpr std::size_t DEFAULT_TICKS = 20'000'000;
+static constexpr int64_t START_POSITION = INT32_MAX - 5'000;
+static constexpr double MAX_SUM_DRIFT = 1e-3; // inches
+static constexpr std::size_t REPORTS = 10;
+
+// Ticks moved on tick i: up to about 4500 either way (roughly 90 inches/second
+// at 10 ms), averaging 700 forwards.
+static int64_t motion(std::size_t i) {
+    return static_cast<int64_t>(std::lround(700.0 + 3800.0 * std::sin(i * 0.0013) * std::cos(i * 0.00071)));
+}
+
+int main(int argc, char** argv) {
+    const std::size_t ticks = argc > 1 ? std::strtoull(argv[1], nullptr, 10) : DEFAULT_TICKS;
+    TrackingWheel wheel(nullptr, static_cast<float>(WHEEL_DIAMETER), 0.0);
+
+    int64_t true_ticks = 0;
+    std::size_t bad_deltas = 0, rollovers = 0;
+    double summed = 0;
+    float summed_float = 0;
+    int32_t position = static_cast<int32_t>(START_POSITION);
+    wheel.set_position(position);
+
+    std::printf("%12s %16s %10s %14s %14s %14s\n", "tick", "true_ticks", "rollovers", "total_err", "sum_drift",
+                "float_drift");
+    for (std::size_t i = 1; i <= ticks; i++) {
+        const int64_t step = motion(i);
+        true_ticks += step;
+        const int32_t next = static_cast<int32_t>(static_cast<uint32_t>(START_POSITION + true_ticks));
+        if ((next < 0) != (position < 0) && std::abs(static_cast<int64_t>(next) - position) > INT32_MAX) rollovers++; // either way
+        position = next;
+
+        if (wheel.peek_delta(position) != step) bad_deltas++;
+        wheel.set_position(position);
+        const double delta = wheel.get_distance_delta();
+        summed += delta;
+        summed_float += static_cast<float>(delta);
+
+        if (i % std::max<std::size_t>(ticks / REPORTS, 1) == 0 || i == ticks) {
+            const double total = wheel.get_distance_total();
+            std::printf("%12zu %16" PRId64 " %10zu %14.3g %14.3g %14.3g\n", i, true_ticks, rollovers,
+                        total - wheel.ticks_to_distance(true_ticks), summed - total, summed_float - total);
+        }
+    }
+
+    const double total = wheel.get_distance_total();
+    const bool exact = total == wheel.ticks_to_distance(true_ticks);
+    const bool ok = bad_deltas == 0 && exact && std::abs(summed - total) <= MAX_SUM_DRIFT && rollovers > 0;
+    std::printf("\n%zu wrong deltas, total %s, %.1f inches travelled net\n", bad_deltas, exact ? "exact" : "off", total);
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,114 @@
+// Checks the tracking wheel health checks against readings taken the way
+// Odometry::sample() takes them: simulated Rotation sensors that update on
+// their own period are read through sample_device() on a 10 ms tick, and
+// the flagged Inputs go through Odometry::update(). Each case drives two
+// vertical wheels (and an IMU holding heading) and checks the wheel status
+// and distance travelled:
+//   moving    both wheels at 40 inches/second, read every other tick; no
+//             wheel may be flagged
+//   frozen    one wheel stops reporting new positions while the other
+//             moves; it must be marked stuck
+//   glitch    a wheel jumps 100 inches after 5 seconds standing still; the
+//             jump must be rejected
+//
+// Build on the host from the repository root (one command):
+//   g++ -std=gnu++20 -O2 -iquote include -iquote include/robot/tracking
+//       -iquote include/utils tools/wheel_health_check.cpp
+//       src/robot/tracking/odometry.cpp src/robot/tracking/pose_history.cpp
+//       src/robot/tracking/imu_drift.cpp src/robot/tracking/tracking_wheel.cpp
+//       src/robot/tracking/drive_encoders.cpp
+//       src/robot/tracking/pose_integrator.cpp
+//       src/robot/tracking/slip_detector.cpp src/utils/pose.cpp
+//       -o wheel_health_check
+//
+// Usage:
+//   wheel_health_check
+//
+// Exits non-zero if any case fails.
+#include "device_sampling.h"
+#include "odometry.h"
+#include "tracking_wheel.h"
+#include <cmath>
+#include <cstdio>
+#include <functional>
+
+static constexpr double WHEEL_DIAMETER = 2.0;
+static constexpr double WHEEL_OFFSETS[2] = {1.5, -1.5};
+static constexpr uint64_t TICK_US = 10'000;
+
+static int32_t wheel_ticks(double distance) {
+    return static_cast<int32_t>(std::lround(distance / (M_PI * WHEEL_DIAMETER) * 36000.0));
+}
+
+struct Result {
+    Odometry::Health health;
+    double travel;
+};
+
+// `distance(wheel, t)` is where wheel `wheel` really is at `t` seconds; the
+// simulated sensor reports it as of its last update on `update_ms`.
+static Result run(double seconds, uint32_t update_ms, uint32_t period_ms,
+                  const std::function<double(std::size_t, double)>& distance) {
+    TrackingWheel wheels[2] = {{nullptr, WHEEL_DIAMETER, WHEEL_OFFSETS[0]}, {nullptr, WHEEL_DIAMETER, WHEEL_OFFSETS[1]}};
+    Odometry odometry({nullptr}, {&wheels[0], &wheels[1]}, {}, 1e-3, 1e-3, 1e-3, 1e-3, 1e-4, 1e-6);
+    odometry.set_filter(OdometryFilter::Ekf);
+    Pose pose(0, 0, 0);
+    odometry.reset(pose);
+
+    Odometry::Inputs inputs = {};
+    std::array<uint64_t, 2> wheel_due{};
+    std::array<SampleStats, 2> wheel_stats{};
+    uint64_t imu_due = 0;
+    SampleStats imu_stats;
+    const uint64_t ticks = static_cast<uint64_t>(seconds * 1e6 / TICK_US);
+    for (uint64_t tick = 1; tick <= ticks; tick++) {
+        const uint64_t now = tick * TICK_US;
+        const double updated_s = (now / (update_ms * 1000ull)) * update_ms / 1e3;
+        inputs.timestamp_us = now;
+        inputs.v_stale = inputs.v_repeat = inputs.imu_stale = 0;
+        for (std::size_t i = 0; i < 2; i++) {
+            flag_sample(sample_device(now, period_ms, wheel_due[i], wheel_stats[i], inputs.v_ticks[i], inputs.v_sample_us[i],
+                                      [&] { return wheel_ticks(distance(i, updated_s)); }),
+                        i, inputs.v_stale, inputs.v_repeat);
+        }
+        if (sample_device(now, 10, imu_due, imu_stats, inputs.imu_headings[0], inputs.imu_sample_us[0],
+                          [] { return 0.0; }) != SampleResult::Fresh) {
+            inputs.imu_stale |= 1;
+        }
+        odometry.update(pose, inputs);
+    }
+    return {odometry.get_health(), std::hypot(pose.x, pose.y)};
+}
+
+static bool check(const char* name, bool ok, const Result& result) {
+    const Odometry::Health& health = result.health;
+    std::printf("%-8s %-4s travel %8.3f", name, ok ? "ok" : "FAIL", result.travel);
+    for (std::size_t i = 0; i < 2; i++) {
+        const SensorStatus& wheel = health.v_wheels[i];
+        std::printf("  v%zu healthy=%d jumps=%u stuck=%u", i, wheel.healthy, wheel.jumps, wheel.stuck);
+    }
+    std::printf("\n");
+    return ok;
+}
+
+static bool untouched(const SensorStatus& wheel) {
+    return wheel.healthy && wheel.jumps == 0 && wheel.stuck == 0;
+}
+
+int main() {
+    bool ok = true;
+
+    const Result moving = run(2.0, 20, 20, [](std::size_t, double t) { return 40.0 * t; });
+    ok &= check("moving", untouched(moving.health.v_wheels[0]) && untouched(moving.health.v_wheels[1]) &&
+                          std::abs(moving.travel - 80.0) < 1.0, moving);
+
+    const Result frozen = run(1.0, 5, 5, [](std::size_t wheel, double t) { return wheel == 1 ? 0.0 : 40.0 * t; });
+    ok &= check("frozen", untouched(frozen.health.v_wheels[0]) && !frozen.health.v_wheels[1].healthy &&
+                          frozen.health.v_wheels[1].stuck == 1, frozen);
+
+    const Result glitch = run(5.5, 5, 5, [](std::size_t wheel, double t) { return wheel == 0 && t >= 5.0 ? 100.0 : 0.0; });
+    ok &= check("glitch", glitch.health.v_wheels[0].jumps == 1 && untouched(glitch.health.v_wheels[1]) &&
+                          glitch.travel < 1.0, glitch);
+
+    return ok ? 0 : 1;
+}